@@ -3,14 +3,26 @@
 #include <string.h>
 #include <stdio.h>
 
-#define NODE_ID int32_t
+// Define RB_INDEX_16 for 16-bit node indices (12-byte nodes, at most 32767 of them)
+#ifdef RB_INDEX_16
+#define NODE_ID uint16_t
+#else
+#define NODE_ID uint32_t
+#endif
 
 #define INIT_CAPACITY 16
 #define GROWTH_FACTOR 2
-#define NULL_NODE -1
+
+// The top bit of a parent index holds the node's color, the largest index left over means no node
+#define NULL_NODE ((NODE_ID)((NODE_ID)~(NODE_ID)0 >> 1))
+#define RED_BIT ((NODE_ID)~NULL_NODE)
+#define MAX_CAPACITY NULL_NODE
 
 #define ERR_NULL_TREE 1
 #define ERR_INVALID_ROT 2
+#define ERR_CAPACITY 3
+#define ERR_NOT_FOUND 4
+#define ERR_UNSORTED 5
 
 enum rb_color
 {
@@ -21,36 +33,63 @@ enum rb_color
 struct rb_node
 {
     int32_t key;
+    NODE_ID parent_color; // Parent index | RED_BIT if red
     union
     {
-        NODE_ID next_free;
-        enum rb_color color;
+        NODE_ID left;
+        NODE_ID next_free; // Free nodes have no children
     };
-    NODE_ID parent;
-    NODE_ID left;
     NODE_ID right;
 };
 
+#ifndef RB_INDEX_16
+_Static_assert(sizeof(struct rb_node) == 16, "rb_node should fit 4 to a cache line");
+#endif
+
+#define RB_PARENT(node) ((NODE_ID)((node)->parent_color & NULL_NODE))
+#define RB_COLOR(node) (((node)->parent_color & RED_BIT) ? RED : BLACK)
+#define RB_SET_PARENT(node, id) ((node)->parent_color = (NODE_ID)(((node)->parent_color & RED_BIT) | (id)))
+#define RB_SET_COLOR(node, color) ((node)->parent_color = (NODE_ID)(((node)->parent_color & NULL_NODE) | ((color) == RED ? RED_BIT : 0)))
+#define RB_SET_PARENT_COLOR(node, id, color) ((node)->parent_color = (NODE_ID)((id) | ((color) == RED ? RED_BIT : 0)))
+
+// Missing children count as black
+#define RB_IS_BLACK(tree, id) ((id) == NULL_NODE || RB_COLOR((tree)->data + (id)) == BLACK)
+
+// Starts loading a node that a descent is about to visit, while the current one is compared
+#if defined(__GNUC__)
+#define RB_PREFETCH(tree, id) do { if ((id) != NULL_NODE) __builtin_prefetch((tree)->data + (id)); } while (0)
+#else
+#define RB_PREFETCH(tree, id) do { } while (0)
+#endif
+
 struct rb_tree
 {
     struct rb_node *data;
     NODE_ID root;
-    int32_t capacity;
+    uint32_t capacity;
     NODE_ID free_list;
 };
 
 /* Internal functions */
 /****************************************************/
-int32_t rb_resize(struct rb_tree *tree, int32_t capacity)
+int32_t rb_resize(struct rb_tree *tree, uint32_t capacity)
 {
     if (tree == NULL || capacity <= tree->capacity)
         return ERR_NULL_TREE;
 
+    // Indices stop short of NULL_NODE
+    if (capacity > MAX_CAPACITY)
+    {
+        if (tree->capacity == MAX_CAPACITY)
+            return ERR_CAPACITY;
+        capacity = MAX_CAPACITY;
+    }
+
     struct rb_node *new_data = malloc(sizeof(struct rb_node) * capacity);
 
     // Construct a free list of the new nodes
-    for (int32_t i = tree->capacity; i < capacity - 1; ++i)
-        new_data[i].next_free = i + 1;
+    for (uint32_t i = tree->capacity; i < capacity - 1; ++i)
+        new_data[i].next_free = (NODE_ID)(i + 1);
     new_data[capacity - 1].next_free = NULL_NODE;
 
     if (tree->data != NULL)
@@ -63,7 +102,7 @@ int32_t rb_resize(struct rb_tree *tree, int32_t capacity)
         free(tree->data);
     }
 
-    tree->free_list = tree->capacity;
+    tree->free_list = (NODE_ID)tree->capacity;
     tree->data = new_data;
     tree->capacity = capacity;
 
@@ -75,8 +114,8 @@ NODE_ID rb_alloc_node(struct rb_tree *tree)
     if (tree == NULL)
         return NULL_NODE;
 
-    if (tree->free_list == NULL_NODE)
-        rb_resize(tree, tree->capacity * GROWTH_FACTOR);
+    if (tree->free_list == NULL_NODE && rb_resize(tree, tree->capacity * GROWTH_FACTOR) != 0)
+        return NULL_NODE;
 
     const NODE_ID new_node_id = tree->free_list;
     tree->free_list = tree->data[new_node_id].next_free;
@@ -84,15 +123,11 @@ NODE_ID rb_alloc_node(struct rb_tree *tree)
     return new_node_id;
 }
 
-void rb_print_inorder(const struct rb_tree *tree, NODE_ID id)
+// Puts a node that is no longer in the tree back on the free list
+void rb_free_node(struct rb_tree *tree, NODE_ID id)
 {
-    if (id == NULL_NODE)
-        return;
-
-    const struct rb_node *node = tree->data + id;
-    rb_print_inorder(tree, node->left);
-    printf("%d%c ", node->key, node->color == RED ? 'r' : 'b');
-    rb_print_inorder(tree, node->right);
+    tree->data[id].next_free = tree->free_list;
+    tree->free_list = id;
 }
 
 int32_t rb_rot_l(struct rb_tree *tree, NODE_ID id)
@@ -105,13 +140,13 @@ int32_t rb_rot_l(struct rb_tree *tree, NODE_ID id)
     if (node->right == NULL_NODE)
         return ERR_INVALID_ROT;
 
-    NODE_ID parent_id = node->parent;
+    NODE_ID parent_id = RB_PARENT(node);
     NODE_ID right_id = node->right;
     struct rb_node *right_child = tree->data + right_id;
     NODE_ID grandchild_id = right_child->left;
 
-    right_child->parent = parent_id;
-    node->parent = right_id;
+    RB_SET_PARENT(right_child, parent_id);
+    RB_SET_PARENT(node, right_id);
     node->right = grandchild_id;
     right_child->left = id;
 
@@ -132,7 +167,7 @@ int32_t rb_rot_l(struct rb_tree *tree, NODE_ID id)
 
     // Relink grandchild
     if (grandchild_id != NULL_NODE)
-        tree->data[grandchild_id].parent = id;
+        RB_SET_PARENT(tree->data + grandchild_id, id);
 
     return 0;
 }
@@ -147,13 +182,13 @@ int32_t rb_rot_r(struct rb_tree *tree, NODE_ID id)
     if (node->left == NULL_NODE)
         return ERR_INVALID_ROT;
 
-    NODE_ID parent_id = node->parent;
+    NODE_ID parent_id = RB_PARENT(node);
     NODE_ID left_id = node->left;
     struct rb_node *left_child = tree->data + left_id;
     NODE_ID grandchild_id = left_child->right;
 
-    left_child->parent = parent_id;
-    node->parent = left_id;
+    RB_SET_PARENT(left_child, parent_id);
+    RB_SET_PARENT(node, left_id);
     node->left = grandchild_id;
     left_child->right = id;
 
@@ -174,7 +209,7 @@ int32_t rb_rot_r(struct rb_tree *tree, NODE_ID id)
 
     // Relink grandchild
     if (grandchild_id != NULL_NODE)
-        tree->data[grandchild_id].parent = id;
+        RB_SET_PARENT(tree->data + grandchild_id, id);
 
     return 0;
 }
@@ -189,62 +224,208 @@ void rb_ins_fix(struct rb_tree *tree, NODE_ID id)
         struct rb_node *node = tree->data + id;
 
         // Case 1: Node is root
-        if (node->parent == NULL_NODE)
+        if (RB_PARENT(node) == NULL_NODE)
         {
-            node->color = BLACK;
+            RB_SET_COLOR(node, BLACK);
             return;
         }
 
-        struct rb_node *parent_node = tree->data + node->parent;
+        struct rb_node *parent_node = tree->data + RB_PARENT(node);
 
         // Case 2: Parent is black
-        if (parent_node->color == BLACK)
+        if (RB_COLOR(parent_node) == BLACK)
             return;
 
-        NODE_ID grandparent = parent_node->parent;
+        NODE_ID grandparent = RB_PARENT(parent_node);
 
         if (grandparent == NULL_NODE)
         {
             // Parent is root
-            id = node->parent;
+            id = RB_PARENT(node);
             continue;
         }
 
         struct rb_node *grandparent_node = tree->data + grandparent;
-        NODE_ID uncle = grandparent_node->left == node->parent
+        NODE_ID uncle = grandparent_node->left == RB_PARENT(node)
             ? grandparent_node->right
             : grandparent_node->left;
         struct rb_node *uncle_node = uncle == NULL_NODE ? NULL : tree->data + uncle;
 
         // Case 3: Parent is red, Uncle is red
-        if (uncle_node && uncle_node->color == RED)
+        if (uncle_node && RB_COLOR(uncle_node) == RED)
         {
-            parent_node->color = BLACK;
-            uncle_node->color = BLACK;
-            grandparent_node->color = RED;
+            RB_SET_COLOR(parent_node, BLACK);
+            RB_SET_COLOR(uncle_node, BLACK);
+            RB_SET_COLOR(grandparent_node, RED);
             id = grandparent;
             continue;
         }
 
         // Case 4: Parent is red, Uncle is black
-        if (parent_node->right == id && grandparent_node->left == node->parent)
-            rb_rot_l(tree, node->parent);
-        else if (parent_node->left == id && grandparent_node->right == node->parent)
-            rb_rot_r(tree, node->parent);
+        // An inner grandchild is first rotated up into its parent's place
+        NODE_ID parent = RB_PARENT(node);
+        if (parent_node->right == id && grandparent_node->left == parent)
+        {
+            rb_rot_l(tree, parent);
+            parent = id;
+            parent_node = node;
+        }
+        else if (parent_node->left == id && grandparent_node->right == parent)
+        {
+            rb_rot_r(tree, parent);
+            parent = id;
+            parent_node = node;
+        }
 
-        if (parent_node->left == id && grandparent_node->left == node->parent)
+        if (grandparent_node->left == parent)
             rb_rot_r(tree, grandparent);
         else
             rb_rot_l(tree, grandparent);
 
         // Switch grandparent and parent color
-        enum rb_color tmp = grandparent_node->color;
-        grandparent_node->color = parent_node->color;
-        parent_node->color = tmp;
+        enum rb_color tmp = RB_COLOR(grandparent_node);
+        RB_SET_COLOR(grandparent_node, RB_COLOR(parent_node));
+        RB_SET_COLOR(parent_node, tmp);
 
         id = grandparent;
     }
 }
+
+// Replaces the subtree rooted at old_id with the one rooted at new_id (which may be NULL_NODE)
+void rb_transplant(struct rb_tree *tree, NODE_ID old_id, NODE_ID new_id)
+{
+    NODE_ID parent = RB_PARENT(tree->data + old_id);
+
+    if (parent == NULL_NODE)
+        tree->root = new_id;
+    else if (tree->data[parent].left == old_id)
+        tree->data[parent].left = new_id;
+    else
+        tree->data[parent].right = new_id;
+
+    if (new_id != NULL_NODE)
+        RB_SET_PARENT(tree->data + new_id, parent);
+}
+
+// id is short one black after a delete. It may be NULL_NODE, so its parent is passed in
+void rb_del_fix(struct rb_tree *tree, NODE_ID id, NODE_ID parent)
+{
+    if (tree == NULL)
+        return;
+
+    while (id != tree->root && RB_IS_BLACK(tree, id))
+    {
+        struct rb_node *parent_node = tree->data + parent;
+
+        // The sibling can't be missing, its side of the tree has at least one more black node
+        if (parent_node->left == id)
+        {
+            NODE_ID sibling = parent_node->right;
+            struct rb_node *sibling_node = tree->data + sibling;
+
+            // Case 1: Sibling is red
+            if (RB_COLOR(sibling_node) == RED)
+            {
+                RB_SET_COLOR(sibling_node, BLACK);
+                RB_SET_COLOR(parent_node, RED);
+                rb_rot_l(tree, parent);
+                sibling = parent_node->right;
+                sibling_node = tree->data + sibling;
+            }
+
+            // Case 2: Sibling is black, both its children are black
+            if (RB_IS_BLACK(tree, sibling_node->left) && RB_IS_BLACK(tree, sibling_node->right))
+            {
+                RB_SET_COLOR(sibling_node, RED);
+                id = parent;
+                parent = RB_PARENT(parent_node);
+                continue;
+            }
+
+            // Case 3: Sibling is black, its far child is black
+            if (RB_IS_BLACK(tree, sibling_node->right))
+            {
+                RB_SET_COLOR(tree->data + sibling_node->left, BLACK);
+                RB_SET_COLOR(sibling_node, RED);
+                rb_rot_r(tree, sibling);
+                sibling = parent_node->right;
+                sibling_node = tree->data + sibling;
+            }
+
+            // Case 4: Sibling is black, its far child is red
+            RB_SET_COLOR(sibling_node, RB_COLOR(parent_node));
+            RB_SET_COLOR(parent_node, BLACK);
+            RB_SET_COLOR(tree->data + sibling_node->right, BLACK);
+            rb_rot_l(tree, parent);
+            id = tree->root;
+        }
+        else
+        {
+            NODE_ID sibling = parent_node->left;
+            struct rb_node *sibling_node = tree->data + sibling;
+
+            // Case 1: Sibling is red
+            if (RB_COLOR(sibling_node) == RED)
+            {
+                RB_SET_COLOR(sibling_node, BLACK);
+                RB_SET_COLOR(parent_node, RED);
+                rb_rot_r(tree, parent);
+                sibling = parent_node->left;
+                sibling_node = tree->data + sibling;
+            }
+
+            // Case 2: Sibling is black, both its children are black
+            if (RB_IS_BLACK(tree, sibling_node->left) && RB_IS_BLACK(tree, sibling_node->right))
+            {
+                RB_SET_COLOR(sibling_node, RED);
+                id = parent;
+                parent = RB_PARENT(parent_node);
+                continue;
+            }
+
+            // Case 3: Sibling is black, its far child is black
+            if (RB_IS_BLACK(tree, sibling_node->left))
+            {
+                RB_SET_COLOR(tree->data + sibling_node->right, BLACK);
+                RB_SET_COLOR(sibling_node, RED);
+                rb_rot_l(tree, sibling);
+                sibling = parent_node->left;
+                sibling_node = tree->data + sibling;
+            }
+
+            // Case 4: Sibling is black, its far child is red
+            RB_SET_COLOR(sibling_node, RB_COLOR(parent_node));
+            RB_SET_COLOR(parent_node, BLACK);
+            RB_SET_COLOR(tree->data + sibling_node->left, BLACK);
+            rb_rot_r(tree, parent);
+            id = tree->root;
+        }
+    }
+
+    if (id != NULL_NODE)
+        RB_SET_COLOR(tree->data + id, BLACK);
+}
+
+/*
+ * Builds a perfectly balanced subtree of keys[lo, hi) around the midpoint and returns its root. Node i holds
+ * keys[i], so the nodes sit in key order. Levels above red_depth are full, so they're black and every path
+ * has the same number of black nodes; the partial level at red_depth is red, and has no children
+ */
+NODE_ID rb_build_range(struct rb_tree *tree, const int32_t *keys, uint32_t lo, uint32_t hi, NODE_ID parent, uint32_t depth, uint32_t red_depth)
+{
+    if (lo == hi)
+        return NULL_NODE;
+
+    const uint32_t mid = lo + (hi - lo) / 2;
+    struct rb_node *node = tree->data + mid;
+
+    node->key = keys[mid];
+    RB_SET_PARENT_COLOR(node, parent, depth == red_depth ? RED : BLACK);
+    node->left = rb_build_range(tree, keys, lo, mid, (NODE_ID)mid, depth + 1, red_depth);
+    node->right = rb_build_range(tree, keys, mid + 1, hi, (NODE_ID)mid, depth + 1, red_depth);
+
+    return (NODE_ID)mid;
+}
 /****************************************************/
 
 
@@ -296,11 +477,12 @@ int32_t rb_insert(struct rb_tree *tree, int32_t val)
 
     // Create and insert the new node
     NODE_ID new_node_id = rb_alloc_node(tree);
+    if (new_node_id == NULL_NODE)
+        return ERR_CAPACITY;
     struct rb_node *new_node = tree->data + new_node_id;
 
-    new_node->parent = parent;
+    RB_SET_PARENT_COLOR(new_node, parent, RED);
     new_node->key = val;
-    new_node->color = RED;
     new_node->left = NULL_NODE;
     new_node->right = NULL_NODE;
 
@@ -316,12 +498,65 @@ int32_t rb_insert(struct rb_tree *tree, int32_t val)
     return 0;
 }
 
+/*
+ * Replaces the tree's contents with n strictly increasing keys in O(n), without any rotations. The node array
+ * is resized at most once. Returns ERR_UNSORTED, leaving the tree alone, if the keys aren't strictly increasing
+ */
+int32_t rb_build_sorted(struct rb_tree *tree, const int32_t *keys, uint32_t n)
+{
+    if (tree == NULL)
+        return ERR_NULL_TREE;
+    if (n > MAX_CAPACITY)
+        return ERR_CAPACITY;
+
+    for (uint32_t i = 1; i < n; ++i)
+    {
+        if (keys[i - 1] >= keys[i])
+            return ERR_UNSORTED;
+    }
+
+    if (n > tree->capacity)
+    {
+        // The old nodes are all being replaced, so there's nothing for rb_resize to copy over
+        free(tree->data);
+        tree->data = NULL;
+        tree->capacity = 0;
+        tree->free_list = NULL_NODE;
+
+        const int32_t err = rb_resize(tree, n);
+        if (err != 0)
+            return err;
+    }
+
+    // Levels 0 to red_depth - 1 are the ones n nodes fill completely
+    uint32_t red_depth = 0;
+    while ((n + 1) >> (red_depth + 1) != 0)
+        ++red_depth;
+
+    tree->root = rb_build_range(tree, keys, 0, n, NULL_NODE, 0, red_depth);
+
+    // The nodes past the keys make up the free list
+    for (uint32_t i = n; i + 1 < tree->capacity; ++i)
+        tree->data[i].next_free = (NODE_ID)(i + 1);
+    if (n < tree->capacity)
+    {
+        tree->data[tree->capacity - 1].next_free = NULL_NODE;
+        tree->free_list = (NODE_ID)n;
+    }
+    else
+        tree->free_list = NULL_NODE;
+
+    return 0;
+}
+
 NODE_ID rb_find(const struct rb_tree *tree, int32_t val)
 {
     NODE_ID curr = tree->root;
     while (curr != NULL_NODE)
     {
         const struct rb_node *node = tree->data + curr;
+        RB_PREFETCH(tree, node->left);
+        RB_PREFETCH(tree, node->right);
         if (node->key == val)
             return curr;
         if (val < node->key)
@@ -332,12 +567,174 @@ NODE_ID rb_find(const struct rb_tree *tree, int32_t val)
     return NULL_NODE;
 }
 
+#define rb_contains(tree, val) (rb_find(tree, val) != NULL_NODE)
+
+// First node with a key >= val, or NULL_NODE
+NODE_ID rb_lower_bound(const struct rb_tree *tree, int32_t val)
+{
+    NODE_ID curr = tree->root;
+    NODE_ID found = NULL_NODE;
+    while (curr != NULL_NODE)
+    {
+        const struct rb_node *node = tree->data + curr;
+        RB_PREFETCH(tree, node->left);
+        RB_PREFETCH(tree, node->right);
+        if (node->key >= val)
+        {
+            found = curr;
+            curr = node->left;
+        }
+        else
+            curr = node->right;
+    }
+    return found;
+}
+
+// First node with a key > val, or NULL_NODE
+NODE_ID rb_upper_bound(const struct rb_tree *tree, int32_t val)
+{
+    NODE_ID curr = tree->root;
+    NODE_ID found = NULL_NODE;
+    while (curr != NULL_NODE)
+    {
+        const struct rb_node *node = tree->data + curr;
+        RB_PREFETCH(tree, node->left);
+        RB_PREFETCH(tree, node->right);
+        if (node->key > val)
+        {
+            found = curr;
+            curr = node->left;
+        }
+        else
+            curr = node->right;
+    }
+    return found;
+}
+
+// Node with the smallest key, or NULL_NODE if the tree is empty
+NODE_ID rb_first(const struct rb_tree *tree)
+{
+    NODE_ID curr = tree->root;
+    if (curr == NULL_NODE)
+        return NULL_NODE;
+
+    while (tree->data[curr].left != NULL_NODE)
+        curr = tree->data[curr].left;
+    return curr;
+}
+
+// In-order successor of id, or NULL_NODE. Walks parent links, so needs no stack
+NODE_ID rb_next(const struct rb_tree *tree, NODE_ID id)
+{
+    const struct rb_node *node = tree->data + id;
+    if (node->right != NULL_NODE)
+    {
+        id = node->right;
+        while (tree->data[id].left != NULL_NODE)
+            id = tree->data[id].left;
+        return id;
+    }
+
+    // Climb until coming up from a left child
+    NODE_ID parent = RB_PARENT(node);
+    while (parent != NULL_NODE && tree->data[parent].right == id)
+    {
+        id = parent;
+        parent = RB_PARENT(tree->data + parent);
+    }
+    return parent;
+}
+
+// Copies the keys in [lo, hi], in order, into out_buf until cap of them are written. Returns how many were
+uint32_t rb_range(const struct rb_tree *tree, int32_t lo, int32_t hi, int32_t *out_buf, uint32_t cap)
+{
+    if (tree == NULL)
+        return 0;
+
+    uint32_t count = 0;
+    for (NODE_ID id = rb_lower_bound(tree, lo); id != NULL_NODE && count < cap; id = rb_next(tree, id))
+    {
+        const int32_t key = tree->data[id].key;
+        if (key > hi)
+            break;
+        out_buf[count++] = key;
+    }
+    return count;
+}
+
+int32_t rb_delete(struct rb_tree *tree, int32_t val)
+{
+    if (tree == NULL)
+        return ERR_NULL_TREE;
+
+    NODE_ID id = rb_find(tree, val);
+    if (id == NULL_NODE)
+        return ERR_NOT_FOUND;
+
+    struct rb_node *node = tree->data + id;
+    enum rb_color removed_color = RB_COLOR(node);
+    NODE_ID child;        // Takes the place of the node that leaves its spot
+    NODE_ID child_parent; // Where that is, in case child is NULL_NODE
+
+    if (node->left == NULL_NODE)
+    {
+        child = node->right;
+        child_parent = RB_PARENT(node);
+        rb_transplant(tree, id, child);
+    }
+    else if (node->right == NULL_NODE)
+    {
+        child = node->left;
+        child_parent = RB_PARENT(node);
+        rb_transplant(tree, id, child);
+    }
+    else
+    {
+        // The successor moves into the node's place and color, so it's the successor's spot that loses a node
+        NODE_ID succ = node->right;
+        while (tree->data[succ].left != NULL_NODE)
+            succ = tree->data[succ].left;
+
+        struct rb_node *succ_node = tree->data + succ;
+        removed_color = RB_COLOR(succ_node);
+        child = succ_node->right;
+
+        if (RB_PARENT(succ_node) == id)
+        {
+            child_parent = succ;
+        }
+        else
+        {
+            child_parent = RB_PARENT(succ_node);
+            rb_transplant(tree, succ, child);
+            succ_node->right = node->right;
+            RB_SET_PARENT(tree->data + succ_node->right, succ);
+        }
+
+        rb_transplant(tree, id, succ);
+        succ_node->left = node->left;
+        RB_SET_PARENT(tree->data + succ_node->left, succ);
+        RB_SET_COLOR(succ_node, RB_COLOR(node));
+    }
+
+    rb_free_node(tree, id);
+
+    if (removed_color == BLACK)
+        rb_del_fix(tree, child, child_parent);
+
+    return 0;
+}
+
 void rb_print(const struct rb_tree *tree)
 {
     if (tree == NULL)
         return;
 
-    rb_print_inorder(tree, tree->root);
+    for (NODE_ID id = rb_first(tree); id != NULL_NODE; id = rb_next(tree, id))
+    {
+        const struct rb_node *node = tree->data + id;
+        printf("%d%c ", node->key, RB_COLOR(node) == RED ? 'r' : 'b');
+    }
 }
 
 // Tree printing
@@ -408,7 +805,7 @@ void rb_pretty_print(const struct rb_tree *tree)
         else
         {
             struct rb_node *node = tree->data + queue[curr].id;
-            printf("%d%c", node->key, node->color == RED ? 'r' : 'b');
+            printf("%d%c", node->key, RB_COLOR(node) == RED ? 'r' : 'b');
 
             const uint32_t pos_diff = (indent >> 1) + 1;
 
@@ -423,8 +820,6 @@ void rb_pretty_print(const struct rb_tree *tree)
 }
 /*********************************/
 
-#define rb_contains(tree, val) rb_index_of(tree, val) != NULL_NODE
-
 int main()
 {
     struct rb_tree rb;
@@ -440,6 +835,26 @@ int main()
     rb_pretty_print(&rb);
     printf("\n\n");
 
+    for (int i = 1; i < 20; i += 3)
+    {
+        rb_delete(&rb, i);
+        rb_print(&rb);
+        printf("\n");
+    }
+
+    rb_pretty_print(&rb);
+    printf("\n\n");
+
+    int32_t sorted_keys[20];
+    for (int i = 0; i < 20; ++i)
+        sorted_keys[i] = i * 2;
+
+    rb_build_sorted(&rb, sorted_keys, 20);
+    rb_print(&rb);
+    printf("\n");
+    rb_pretty_print(&rb);
+    printf("\n\n");
+
     rb_free(&rb);
     return 0;
 }
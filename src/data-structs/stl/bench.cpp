@@ -0,0 +1,280 @@
+#include <vector>
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+ * Microbenchmarks of mystl::vector against std::vector.
+ *
+ * Both containers get the same counting_allocator, so the allocation counts line up. It also
+ * offers reallocate() (realloc), through which mystl::vector grows its buffer (push_back,
+ * reserve, shrink_to_fit) when the elements are trivially relocatable, int and pod64 here;
+ * a reallocate() counts as one allocation of the new size. std::vector has no use for it.
+ *
+ * Only the containers' own buffers are counted. The heap blocks std::string elements own come
+ * from std::allocator and are left out, so a string copy's per-element allocations don't show.
+ *
+ * Usage: bench [csv|json]   (defaults to csv)
+ */
+
+// Allocation counting
+/******************************************************************************/
+struct alloc_stats
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+inline alloc_stats g_alloc_stats;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count)
+    {
+        ++g_alloc_stats.allocations;
+        g_alloc_stats.bytes += count * sizeof(T);
+        if (auto p = std::malloc(count * sizeof(T)))
+            return static_cast<T*>(p);
+        throw std::bad_alloc{};
+    }
+
+    void deallocate(T* p, std::size_t) noexcept { std::free(p); }
+
+    T* reallocate(T* p, std::size_t, std::size_t new_count)
+    {
+        ++g_alloc_stats.allocations;
+        g_alloc_stats.bytes += new_count * sizeof(T);
+        if (auto new_p = std::realloc(p, new_count * sizeof(T)))
+            return static_cast<T*>(new_p);
+        throw std::bad_alloc{};
+    }
+
+    friend bool operator==(const counting_allocator&, const counting_allocator&) noexcept { return true; }
+};
+/******************************************************************************/
+
+// Element types
+/******************************************************************************/
+struct pod64
+{
+    std::uint64_t words[8];
+};
+
+template<typename T>
+T make(std::size_t i)
+{
+    if constexpr (std::is_same_v<T, std::string>)
+        return std::string(32, static_cast<char>('a' + i % 26)); // Too long for the small string buffer
+    else if constexpr (std::is_same_v<T, pod64>)
+        return pod64{{i, i, i, i, i, i, i, i}};
+    else
+        return static_cast<T>(i);
+}
+/******************************************************************************/
+
+// Timing
+/******************************************************************************/
+std::uint64_t cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Stops the compiler from optimising away work whose result is never read
+template<typename T>
+void do_not_optimize(T& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct result
+{
+    std::string_view container;
+    std::string_view element;
+    std::string_view workload;
+    std::size_t ops;
+    double ns_per_op;
+    double cycles_per_op;
+    std::uint64_t allocations_per_run;
+    std::uint64_t bytes_per_run;
+};
+
+constexpr int REPETITIONS = 7;
+
+/*
+ * Runs prepare() then work() REPETITIONS times and keeps the fastest run, which is the one
+ * least disturbed by the rest of the system. Only work() is timed and counted.
+ */
+template<typename Prepare, typename Work>
+result measure(std::size_t ops, Prepare prepare, Work work)
+{
+    auto best_ns = std::chrono::nanoseconds::max();
+    std::uint64_t best_cycles = 0;
+    alloc_stats stats;
+
+    for (int rep = 0; rep < REPETITIONS; ++rep)
+    {
+        auto state = prepare();
+        const auto before = g_alloc_stats;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto start_cycles = cycles();
+        work(state);
+        const auto end_cycles = cycles();
+        const auto end = std::chrono::steady_clock::now();
+
+        stats.allocations = g_alloc_stats.allocations - before.allocations;
+        stats.bytes = g_alloc_stats.bytes - before.bytes;
+        if (end - start < best_ns)
+        {
+            best_ns = end - start;
+            best_cycles = end_cycles - start_cycles;
+        }
+    }
+
+    return {{}, {}, {}, ops,
+        static_cast<double>(best_ns.count()) / ops,
+        static_cast<double>(best_cycles) / ops,
+        stats.allocations,
+        stats.bytes};
+}
+/******************************************************************************/
+
+// Workloads
+/******************************************************************************/
+constexpr std::size_t APPEND_COUNT = 1 << 16;
+constexpr std::size_t MIDDLE_COUNT = 1 << 12;
+
+template<typename Vec>
+Vec filled(std::size_t count)
+{
+    Vec v;
+    v.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        v.push_back(make<typename Vec::value_type>(i));
+    return v;
+}
+
+template<typename Vec>
+void run_workloads(std::string_view container, std::string_view element, std::vector<result>& out)
+{
+    using T = typename Vec::value_type;
+
+    auto add = [&](std::string_view workload, result r)
+    {
+        r.container = container;
+        r.element = element;
+        r.workload = workload;
+        out.push_back(r);
+    };
+
+    // Elements are made up front so that only the container's own work is timed
+    const auto values = [] { std::vector<T> vals; for (std::size_t i = 0; i < APPEND_COUNT; ++i) vals.push_back(make<T>(i)); return vals; }();
+
+    add("push_back", measure(APPEND_COUNT,
+        [] { return Vec{}; },
+        [&](Vec& v) { for (const auto& val : values) v.push_back(val); do_not_optimize(v); }));
+
+    add("reserve+push_back", measure(APPEND_COUNT,
+        [] { return Vec{}; },
+        [&](Vec& v) { v.reserve(values.size()); for (const auto& val : values) v.push_back(val); do_not_optimize(v); }));
+
+    add("insert_middle", measure(MIDDLE_COUNT,
+        [] { return Vec{}; },
+        [&](Vec& v) { for (std::size_t i = 0; i < MIDDLE_COUNT; ++i) v.insert(v.begin() + v.size() / 2, values[i]); do_not_optimize(v); }));
+
+    add("erase_middle", measure(MIDDLE_COUNT,
+        [] { return filled<Vec>(MIDDLE_COUNT); },
+        [&](Vec& v) { while (!v.empty()) v.erase(v.begin() + v.size() / 2); do_not_optimize(v); }));
+
+    // The results are kept in the state so that destroying them isn't timed
+    using src_dst = std::pair<Vec, Vec>;
+
+    add("copy", measure(APPEND_COUNT,
+        [] { return src_dst{filled<Vec>(APPEND_COUNT), Vec{}}; },
+        [&](src_dst& s) { s.second = Vec(s.first); do_not_optimize(s); }));
+
+    // Per element, for comparison with copy; the move itself is O(1)
+    add("move", measure(APPEND_COUNT,
+        [] { return src_dst{filled<Vec>(APPEND_COUNT), Vec{}}; },
+        [&](src_dst& s) { s.second = Vec(std::move(s.first)); do_not_optimize(s); }));
+}
+
+template<typename T>
+void run_element(std::string_view element, std::vector<result>& out)
+{
+    run_workloads<std::vector<T, counting_allocator<T>>>("std::vector", element, out);
+    run_workloads<mystl::vector<T, counting_allocator<T>>>("mystl::vector", element, out);
+}
+/******************************************************************************/
+
+// Output
+/******************************************************************************/
+void print_csv(const std::vector<result>& results)
+{
+    std::cout << "container,element,workload,ops,ns_per_op,cycles_per_op,allocations,bytes_allocated\n";
+    for (const auto& r : results)
+    {
+        std::cout << r.container << ',' << r.element << ',' << r.workload << ',' << r.ops << ','
+            << r.ns_per_op << ',' << r.cycles_per_op << ',' << r.allocations_per_run << ',' << r.bytes_per_run << '\n';
+    }
+}
+
+void print_json(const std::vector<result>& results)
+{
+    std::cout << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        std::cout << "  {\"container\": \"" << r.container << "\", \"element\": \"" << r.element
+            << "\", \"workload\": \"" << r.workload << "\", \"ops\": " << r.ops
+            << ", \"ns_per_op\": " << r.ns_per_op << ", \"cycles_per_op\": " << r.cycles_per_op
+            << ", \"allocations\": " << r.allocations_per_run << ", \"bytes_allocated\": " << r.bytes_per_run
+            << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    std::cout << "]\n";
+}
+/******************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    const std::string_view format = argc > 1 ? argv[1] : "csv";
+    if (format != "csv" && format != "json")
+    {
+        std::cerr << "usage: " << argv[0] << " [csv|json]\n";
+        return 1;
+    }
+
+    std::vector<result> results;
+    run_element<int>("int", results);
+    run_element<std::string>("string", results);
+    run_element<pod64>("pod64", results);
+
+    if (format == "json")
+        print_json(results);
+    else
+        print_csv(results);
+}
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace mystl
+{
+    /*
+     * Hive that many threads may insert into and erase from at once without a lock.
+     *
+     * Every thread that touches the container gets its own slice of it: an active block it
+     * appends to, the blocks it has filled before, and a free list of the slots erased from
+     * them. A thread only ever inserts into its own blocks, so inserting is a plain pointer
+     * bump or free list pop with no atomics beyond a relaxed size counter. Erasing an element
+     * that another thread inserted pushes its slot onto that owner's remote-free queue, a
+     * lock-free stack the owner takes over in one exchange once its own free list runs dry.
+     *
+     * Elements never move, so pointers and iterators stay valid until the element is erased.
+     * Blocks are only freed by clear() and destruction. A slot erased by another thread stays
+     * with the thread that inserted it (or a later thread that is given the same id).
+     *
+     * Reading or erasing an element inserted by another thread needs the usual
+     * synchronisation with that thread. Iterating, clear() and destruction must not run
+     * concurrently with anything else; size() may, but is then only a snapshot.
+     */
+    template<typename T, typename Allocator = std::allocator<T>>
+    class concurrent_hive
+    {
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+        struct block;
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = value_type*;
+        using const_pointer = const value_type*;
+
+        template<bool Const>
+        class hive_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = concurrent_hive::value_type;
+            using difference_type = concurrent_hive::difference_type;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+            hive_iterator() noexcept = default;
+
+            // Allow iterator -> const_iterator
+            template<bool OtherConst>
+                requires (Const && !OtherConst)
+            hive_iterator(const hive_iterator<OtherConst>& other) noexcept :
+                _block{other._block}, _idx{other._idx}
+            {}
+
+            reference operator*() const noexcept { return _block->data[_idx].value; }
+            pointer operator->() const noexcept { return std::addressof(_block->data[_idx].value); }
+
+            hive_iterator& operator++() noexcept
+            {
+                ++_idx;
+                skip_dead();
+                return *this;
+            }
+            hive_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+            friend bool operator==(const hive_iterator& a, const hive_iterator& b) noexcept
+            {
+                return a._block == b._block && a._idx == b._idx;
+            }
+
+        private:
+            friend class concurrent_hive;
+            friend class hive_iterator<!Const>;
+
+            block* _block = nullptr;
+            size_type _idx = 0;
+
+            hive_iterator(block* b, size_type idx) noexcept : _block{b}, _idx{idx} { skip_dead(); }
+
+            // Moves on to the first live slot at or after this one; end() is {nullptr, 0}
+            void skip_dead() noexcept
+            {
+                while (_block != nullptr)
+                {
+                    while (_idx < _block->used && !_block->live[_idx])
+                        ++_idx;
+                    if (_idx < _block->used)
+                        return;
+                    _block = _block->next;
+                    _idx = 0;
+                }
+            }
+        };
+
+        using iterator = hive_iterator<false>;
+        using const_iterator = hive_iterator<true>;
+
+        static constexpr size_type MIN_BLOCK_CAPACITY = 8;
+        static constexpr size_type MAX_BLOCK_CAPACITY = 8192;
+
+        // Constructors
+        /**********************************************************************/
+        concurrent_hive() noexcept(noexcept(Allocator())) : concurrent_hive(Allocator()) {}
+
+        explicit concurrent_hive(const Allocator& alloc) noexcept :
+            _alloc{alloc}, _slot_alloc{_alloc}, _live_alloc{_alloc}, _block_alloc{_alloc}, _local_alloc{_alloc}
+        {}
+
+        // Every thread holds on to its slice through the id, so there is nothing sensible to copy or move
+        concurrent_hive(const concurrent_hive&) = delete;
+        concurrent_hive& operator=(const concurrent_hive&) = delete;
+        /**********************************************************************/
+
+        ~concurrent_hive()
+        {
+            clear();
+            for (auto l = _locals.load(std::memory_order_relaxed); l != nullptr; )
+            {
+                const auto next = l->next;
+                std::destroy_at(l);
+                local_alloc_traits::deallocate(_local_alloc, l, 1);
+                l = next;
+            }
+        }
+
+        allocator_type get_allocator() const noexcept { return _alloc; }
+
+        // Iterators (not thread safe)
+        /**********************************************************************/
+        iterator begin() noexcept { return {_blocks.load(std::memory_order_acquire), 0}; }
+        const_iterator begin() const noexcept { return {_blocks.load(std::memory_order_acquire), 0}; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return {}; }
+        const_iterator end() const noexcept { return {}; }
+        const_iterator cend() const noexcept { return end(); }
+        /**********************************************************************/
+
+        // Modifiers (safe to call concurrently with each other)
+        /**********************************************************************/
+        template<typename... Args>
+        iterator emplace(Args&&... args)
+        {
+            auto& me = this_thread_local();
+            block* b;
+            size_type idx;
+            bool reused = false;
+
+            if (me.free == nullptr)
+                me.free = me.remote_free.exchange(nullptr, std::memory_order_acquire);
+
+            if (me.free != nullptr)
+            {
+                const auto node = std::exchange(me.free, me.free->next);
+                b = node->owner;
+                idx = static_cast<size_type>(reinterpret_cast<slot*>(node) - std::to_address(b->data));
+                reused = true;
+            }
+            else
+            {
+                if (me.active == nullptr || me.active->used == me.active->cap)
+                    me.active = create_block(me);
+                b = me.active;
+                idx = b->used;
+            }
+
+            try
+            {
+                alloc_traits::construct(_alloc, std::addressof(b->data[idx].value), std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                if (reused)
+                    push_local_free(me, b, idx);
+                throw;
+            }
+
+            if (!reused)
+                ++b->used;
+            b->live[idx] = true;
+            me.inserted.store(me.inserted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return {b, idx};
+        }
+        iterator insert(const T& value) { return emplace(value); }
+        iterator insert(T&& value) { return emplace(std::move(value)); }
+
+        // The slot goes back to the thread that inserted into it, straight away if that's this one
+        void erase(const_iterator pos)
+        {
+            const auto b = pos._block;
+            const auto idx = pos._idx;
+            auto& me = this_thread_local();
+
+            alloc_traits::destroy(_alloc, std::addressof(b->data[idx].value));
+            b->live[idx] = false;
+            me.erased.store(me.erased.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+            if (b->owner == &me)
+            {
+                push_local_free(me, b, idx);
+                return;
+            }
+
+            const auto node = std::construct_at(&b->data[idx].node, free_node{nullptr, b});
+            auto& remote = b->owner->remote_free;
+            node->next = remote.load(std::memory_order_relaxed);
+            while (!remote.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+                ;
+        }
+        /**********************************************************************/
+
+        // Modifiers (not thread safe)
+        /**********************************************************************/
+        // Destroys every element and frees every block
+        void clear() noexcept
+        {
+            for (auto b = _blocks.exchange(nullptr, std::memory_order_relaxed); b != nullptr; )
+            {
+                for (size_type i = 0; i < b->used; ++i)
+                    if (b->live[i])
+                        alloc_traits::destroy(_alloc, std::addressof(b->data[i].value));
+                destroy_block(std::exchange(b, b->next));
+            }
+
+            for (auto l = _locals.load(std::memory_order_relaxed); l != nullptr; l = l->next)
+            {
+                l->active = nullptr;
+                l->free = nullptr;
+                l->remote_free.store(nullptr, std::memory_order_relaxed);
+                l->inserted.store(0, std::memory_order_relaxed);
+                l->erased.store(0, std::memory_order_relaxed);
+                l->nx_block_sz = MIN_BLOCK_CAPACITY;
+            }
+        }
+        /**********************************************************************/
+
+        // Capacity
+        /**********************************************************************/
+        size_type size() const noexcept
+        {
+            size_type inserted = 0, erased = 0;
+            for (auto l = _locals.load(std::memory_order_acquire); l != nullptr; l = l->next)
+            {
+                inserted += l->inserted.load(std::memory_order_relaxed);
+                erased += l->erased.load(std::memory_order_relaxed);
+            }
+            // Erases may be seen before the inserts they undo
+            return inserted > erased ? inserted - erased : 0;
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+        size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max() / sizeof(slot); }
+        /**********************************************************************/
+
+    private:
+        struct local;
+
+        // An erased slot, linked into its owner's free list or remote-free queue
+        struct free_node
+        {
+            free_node* next;
+            block* owner;
+        };
+
+        union slot
+        {
+            T value;
+            free_node node;
+
+            slot() noexcept {}
+            ~slot() {}
+        };
+
+        using slot_allocator_type = typename alloc_traits::template rebind_alloc<slot>;
+        using live_allocator_type = typename alloc_traits::template rebind_alloc<bool>;
+        using block_allocator_type = typename alloc_traits::template rebind_alloc<block>;
+        using local_allocator_type = typename alloc_traits::template rebind_alloc<local>;
+
+        using slot_alloc_traits = std::allocator_traits<slot_allocator_type>;
+        using live_alloc_traits = std::allocator_traits<live_allocator_type>;
+        using block_alloc_traits = std::allocator_traits<block_allocator_type>;
+        using local_alloc_traits = std::allocator_traits<local_allocator_type>;
+
+        struct block
+        {
+            typename slot_alloc_traits::pointer data;
+            typename live_alloc_traits::pointer live; // Whether each slot holds an element, read when iterating
+            size_type cap;
+            size_type used;                           // Slots [0, used) have held an element, the rest never have
+            local* owner;
+            block* next;                              // All blocks, newest first
+        };
+
+        // One thread's slice of the hive. Everything but the atomics is only touched by that thread
+        struct local
+        {
+            std::thread::id id;
+            local* next;                              // All slices, newest first
+            block* active = nullptr;
+            free_node* free = nullptr;
+            std::atomic<free_node*> remote_free = nullptr;
+            std::atomic<size_type> inserted = 0;      // Counted apart so that threads don't share a counter
+            std::atomic<size_type> erased = 0;
+            size_type nx_block_sz = MIN_BLOCK_CAPACITY;
+
+            local(std::thread::id owner, local* next_local) noexcept : id{owner}, next{next_local} {}
+        };
+
+        static constexpr size_type GROWTH_FACTOR = 2;
+
+        // Tells hives apart in the per-thread lookup cache, even one made where another used to be
+        static inline std::atomic<std::uint64_t> next_uid = 1;
+
+        allocator_type _alloc;
+        slot_allocator_type _slot_alloc;
+        live_allocator_type _live_alloc;
+        block_allocator_type _block_alloc;
+        local_allocator_type _local_alloc;
+        const std::uint64_t _uid = next_uid.fetch_add(1, std::memory_order_relaxed);
+        std::atomic<block*> _blocks = nullptr;
+        std::atomic<local*> _locals = nullptr;
+
+        // The calling thread's slice, made on its first visit. Remembers the last hive it was asked about
+        local& this_thread_local()
+        {
+            thread_local std::uint64_t cached_uid = 0;
+            thread_local local* cached = nullptr;
+            if (cached_uid == _uid)
+                return *cached;
+
+            const auto me = std::this_thread::get_id();
+            auto head = _locals.load(std::memory_order_acquire);
+            for (auto l = head; l != nullptr; l = l->next)
+            {
+                if (l->id == me)
+                {
+                    cached_uid = _uid;
+                    cached = l;
+                    return *l;
+                }
+            }
+
+            // Only this thread can add a slice with its id, so whatever was pushed meanwhile isn't it
+            const auto l = std::to_address(local_alloc_traits::allocate(_local_alloc, 1));
+            std::construct_at(l, me, head);
+            while (!_locals.compare_exchange_weak(l->next, l, std::memory_order_release, std::memory_order_relaxed))
+                ;
+
+            cached_uid = _uid;
+            cached = l;
+            return *l;
+        }
+
+        block* create_block(local& owner)
+        {
+            const auto cap = owner.nx_block_sz;
+            const auto data = slot_alloc_traits::allocate(_slot_alloc, cap);
+            typename live_alloc_traits::pointer live{};
+            block* b = nullptr;
+            try
+            {
+                live = live_alloc_traits::allocate(_live_alloc, cap);
+                b = std::to_address(block_alloc_traits::allocate(_block_alloc, 1));
+            }
+            catch (...)
+            {
+                if (live != nullptr)
+                    live_alloc_traits::deallocate(_live_alloc, live, cap);
+                slot_alloc_traits::deallocate(_slot_alloc, data, cap);
+                throw;
+            }
+
+            std::uninitialized_fill_n(std::to_address(live), cap, false);
+            std::construct_at(b, block{data, live, cap, 0, &owner, _blocks.load(std::memory_order_relaxed)});
+            while (!_blocks.compare_exchange_weak(b->next, b, std::memory_order_release, std::memory_order_relaxed))
+                ;
+
+            owner.nx_block_sz = std::min(MAX_BLOCK_CAPACITY, cap * GROWTH_FACTOR);
+            return b;
+        }
+
+        void destroy_block(block* b) noexcept
+        {
+            live_alloc_traits::deallocate(_live_alloc, b->live, b->cap);
+            slot_alloc_traits::deallocate(_slot_alloc, b->data, b->cap);
+            std::destroy_at(b);
+            block_alloc_traits::deallocate(_block_alloc, b, 1);
+        }
+
+        static void push_local_free(local& me, block* b, size_type idx) noexcept
+        {
+            me.free = std::construct_at(&b->data[idx].node, free_node{me.free, b});
+        }
+    };
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+namespace mystl
+{
+    /*
+     * Append-only vector that many threads may grow at once without a lock.
+     *
+     * Elements live in segments that double in size, the same growth vector gets from
+     * doubling_growth: segment k holds FIRST_SEGMENT_SIZE << k elements. Segments are never
+     * reallocated, so elements never move and references, pointers and iterators stay valid
+     * for as long as the container lives. A push_back claims its slot with a single fetch_add
+     * and only the thread that first reaches a segment allocates it (losing racers free
+     * theirs), so appends don't contend beyond that counter and the one booking room to
+     * record a failed constructor (see below).
+     *
+     * Like TBB's concurrent_vector, size() counts claimed slots, which may include elements
+     * still being constructed by other threads. Reading an element appended by another
+     * thread needs the usual synchronisation with that thread (e.g. joining it); the
+     * reference or index returned by push_back is always safe for the caller itself.
+     *
+     * If an element's constructor throws, its slot stays claimed but holds no object; the
+     * exception propagates and the slot is skipped on destruction. Accessing it is undefined.
+     * The same goes for the slots after it in a grow_by run, which are never constructed.
+     * Every append books room for that record before claiming anything, so recording the
+     * failure never has to allocate (and can't fail) once an exception is on its way out.
+     *
+     * clear() and destruction must not run concurrently with anything else.
+     */
+    template<typename T, typename Allocator = std::allocator<T>>
+    class concurrent_vector
+    {
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = typename alloc_traits::pointer;
+        using const_pointer = typename alloc_traits::const_pointer;
+
+        template<bool Const>
+        class index_iterator
+        {
+        private:
+            using owner_type = std::conditional_t<Const, const concurrent_vector, concurrent_vector>;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = concurrent_vector::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+            index_iterator() noexcept = default;
+            index_iterator(owner_type* owner, size_type pos) noexcept : _owner{owner}, _pos{pos} {}
+
+            // Allow iterator -> const_iterator
+            template<bool OtherConst>
+                requires (Const && !OtherConst)
+            index_iterator(const index_iterator<OtherConst>& other) noexcept :
+                _owner{other._owner}, _pos{other._pos}
+            {}
+
+            reference operator*() const { return (*_owner)[_pos]; }
+            pointer operator->() const { return std::addressof((*_owner)[_pos]); }
+            reference operator[](difference_type n) const { return (*_owner)[_pos + n]; }
+
+            index_iterator& operator++() noexcept { ++_pos; return *this; }
+            index_iterator operator++(int) noexcept { auto tmp = *this; ++_pos; return tmp; }
+            index_iterator& operator--() noexcept { --_pos; return *this; }
+            index_iterator operator--(int) noexcept { auto tmp = *this; --_pos; return tmp; }
+            index_iterator& operator+=(difference_type n) noexcept { _pos += n; return *this; }
+            index_iterator& operator-=(difference_type n) noexcept { _pos -= n; return *this; }
+
+            friend index_iterator operator+(index_iterator it, difference_type n) noexcept { return it += n; }
+            friend index_iterator operator+(difference_type n, index_iterator it) noexcept { return it += n; }
+            friend index_iterator operator-(index_iterator it, difference_type n) noexcept { return it -= n; }
+            friend difference_type operator-(const index_iterator& a, const index_iterator& b) noexcept
+            {
+                return static_cast<difference_type>(a._pos) - static_cast<difference_type>(b._pos);
+            }
+
+            friend bool operator==(const index_iterator& a, const index_iterator& b) noexcept { return a._pos == b._pos; }
+            friend auto operator<=>(const index_iterator& a, const index_iterator& b) noexcept { return a._pos <=> b._pos; }
+
+            size_type index() const noexcept { return _pos; }
+
+        private:
+            friend class index_iterator<!Const>;
+
+            owner_type* _owner = nullptr;
+            size_type _pos = 0;
+        };
+
+        using iterator = index_iterator<false>;
+        using const_iterator = index_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_type FIRST_SEGMENT_SIZE = std::bit_floor(std::max<size_type>(1, 512 / sizeof(T)));
+
+        // Constructors
+        /**********************************************************************/
+        concurrent_vector() noexcept(noexcept(Allocator())) = default;
+        explicit concurrent_vector(const Allocator& alloc) noexcept : _alloc{alloc} {}
+
+        // Growing happens in place, so there is nothing sensible for a concurrent copy or move to do
+        concurrent_vector(const concurrent_vector&) = delete;
+        concurrent_vector& operator=(const concurrent_vector&) = delete;
+        /**********************************************************************/
+
+        ~concurrent_vector()
+        {
+            clear();
+            for (size_type k = 0; k < MAX_SEGMENTS; ++k)
+                free_segment(k);
+        }
+
+        allocator_type get_allocator() const noexcept { return _alloc; }
+
+        // Element access
+        /**********************************************************************/
+        reference at(size_type pos) { check_bounds(pos); return (*this)[pos]; }
+        const_reference at(size_type pos) const { check_bounds(pos); return (*this)[pos]; }
+
+        reference operator[](size_type pos) noexcept { return *slot(pos); }
+        const_reference operator[](size_type pos) const noexcept { return *slot(pos); }
+
+        reference front() noexcept { return (*this)[0]; }
+        const_reference front() const noexcept { return (*this)[0]; }
+        reference back() noexcept { return (*this)[size() - 1]; }
+        const_reference back() const noexcept { return (*this)[size() - 1]; }
+        /**********************************************************************/
+
+        // Iterators
+        /**********************************************************************/
+        // end() is fixed at the size when it is called; later appends aren't picked up
+        iterator begin() noexcept { return {this, 0}; }
+        const_iterator begin() const noexcept { return {this, 0}; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return {this, size()}; }
+        const_iterator end() const noexcept { return {this, size()}; }
+        const_iterator cend() const noexcept { return end(); }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+        reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+        const_reverse_iterator crend() const noexcept { return rend(); }
+        /**********************************************************************/
+
+        // Modifiers (safe to call concurrently with each other and with element access)
+        /**********************************************************************/
+        reference push_back(const T& value) { return emplace_back(value); }
+        reference push_back(T&& value) { return emplace_back(std::move(value)); }
+
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            book_failure_entry();
+            const auto pos = _sz.fetch_add(1, std::memory_order_relaxed);
+            pointer p;
+            try
+            {
+                p = construct_at_index(pos, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                record_failure(pos, pos + 1);
+                throw;
+            }
+            unbook_failure_entry();
+            return *p;
+        }
+
+        // Appends count copies of value as one contiguous run of indices. Returns the first index
+        size_type grow_by(size_type count, const T& value)
+        {
+            book_failure_entry();
+            const auto first = _sz.fetch_add(count, std::memory_order_relaxed);
+            size_type i = 0;
+            try
+            {
+                for (; i < count; ++i)
+                    construct_at_index(first + i, value);
+            }
+            catch (...)
+            {
+                // The failed slot and the rest of the run after it never got an object
+                const auto last = count <= max_size() - std::min(first, max_size()) ? first + count : max_size();
+                record_failure(first + i, last);
+                throw;
+            }
+            unbook_failure_entry();
+            return first;
+        }
+
+        // Makes sure segments for the first count elements exist, so appends up to there never allocate
+        void reserve(size_type count)
+        {
+            if (count == 0)
+                return;
+            for (size_type k = 0; k <= segment_of(count - 1); ++k)
+                get_segment(k);
+        }
+        /**********************************************************************/
+
+        // Modifiers (not thread safe)
+        /**********************************************************************/
+        // Destroys every element but keeps the segments for reuse
+        void clear() noexcept
+        {
+            const auto sz = size();
+            auto failed = _failed.begin();
+            for (size_type i = 0; i < sz; )
+            {
+                if (failed != _failed.end() && failed->first == i)
+                {
+                    i = (failed++)->second;
+                    continue;
+                }
+                alloc_traits::destroy(_alloc, slot(i++));
+            }
+
+            _failed.clear();
+            _failed_spare.store(static_cast<difference_type>(_failed.capacity()), std::memory_order_relaxed);
+            _sz.store(0, std::memory_order_relaxed);
+        }
+        /**********************************************************************/
+
+        // Capacity
+        /**********************************************************************/
+        size_type size() const noexcept { return std::min(_sz.load(std::memory_order_acquire), max_size()); }
+        bool empty() const noexcept { return size() == 0; }
+
+        // Elements that fit into the segments allocated so far without allocating more
+        size_type capacity() const noexcept
+        {
+            size_type k = 0;
+            while (k < MAX_SEGMENTS && _segments[k].load(std::memory_order_acquire) != nullptr)
+                ++k;
+            return segment_start(k);
+        }
+
+        static constexpr size_type max_size() noexcept
+        {
+            return std::min<size_type>(std::numeric_limits<difference_type>::max() / sizeof(T), segment_start(MAX_SEGMENTS));
+        }
+        /**********************************************************************/
+
+    private:
+        // Enough segments for any index, however far up the address space it is. With a power of two
+        // FIRST_SEGMENT_SIZE, the last one ends exactly at the top of size_type
+        static constexpr size_type MAX_SEGMENTS = std::numeric_limits<size_type>::digits - std::bit_width(FIRST_SEGMENT_SIZE) + 1;
+
+        Allocator _alloc{};
+        std::array<std::atomic<pointer>, MAX_SEGMENTS> _segments{};
+        std::atomic<size_type> _sz = 0;
+
+        // [first, last) runs of slots whose constructor threw, kept sorted. Only touched on that
+        // (rare) path, when booking more room and by clear()
+        std::mutex _failed_mutex;
+        vector<std::pair<size_type, size_type>> _failed;
+
+        // Room left in _failed's capacity once every booked entry is used. Appends in flight hold one booking each
+        std::atomic<difference_type> _failed_spare = 0;
+
+        static constexpr size_type segment_size(size_type k) noexcept { return FIRST_SEGMENT_SIZE << k; }
+
+        // Index of the first element in segment k, FIRST_SEGMENT_SIZE * (2^k - 1)
+        static constexpr size_type segment_start(size_type k) noexcept
+        {
+            return k >= std::numeric_limits<size_type>::digits ? std::numeric_limits<size_type>::max() : FIRST_SEGMENT_SIZE * ((size_type{1} << k) - 1);
+        }
+
+        static constexpr size_type segment_of(size_type pos) noexcept
+        {
+            return std::bit_width(pos / FIRST_SEGMENT_SIZE + 1) - 1;
+        }
+
+        pointer slot(size_type pos) const noexcept
+        {
+            const auto k = segment_of(pos);
+            return _segments[k].load(std::memory_order_acquire) + (pos - segment_start(k));
+        }
+
+        // Returns segment k, allocating it if this is the first thread to need it
+        pointer get_segment(size_type k)
+        {
+            auto seg = _segments[k].load(std::memory_order_acquire);
+            if (seg != nullptr)
+                return seg;
+
+            auto fresh = alloc_traits::allocate(_alloc, segment_size(k));
+            if (_segments[k].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+                return fresh;
+
+            // Another thread got there first, seg now holds its segment
+            alloc_traits::deallocate(_alloc, fresh, segment_size(k));
+            return seg;
+        }
+
+        void free_segment(size_type k) noexcept
+        {
+            if (auto seg = _segments[k].exchange(nullptr, std::memory_order_relaxed); seg != nullptr)
+                alloc_traits::deallocate(_alloc, seg, segment_size(k));
+        }
+
+        template<typename... Args>
+        pointer construct_at_index(size_type pos, Args&&... args)
+        {
+            if (pos >= max_size())
+                throw std::length_error{"concurrent_vector: exceeded max_size()"};
+
+            const auto k = segment_of(pos);
+            const auto p = get_segment(k) + (pos - segment_start(k));
+            alloc_traits::construct(_alloc, std::to_address(p), std::forward<Args>(args)...);
+            return p;
+        }
+
+        // Makes sure _failed can take one more entry without allocating. Called before claiming any slot
+        void book_failure_entry()
+        {
+            if (_failed_spare.fetch_sub(1, std::memory_order_relaxed) > 0)
+                return;
+
+            std::scoped_lock lock{_failed_mutex};
+            const auto spare = _failed_spare.load(std::memory_order_relaxed);
+            if (spare >= 0)
+                return; // Another thread made room in the meantime
+
+            try
+            {
+                const auto cap = _failed.capacity();
+                const auto new_cap = std::max({cap * 2, cap + static_cast<size_type>(-spare), size_type{8}});
+                _failed.reserve(new_cap);
+                _failed_spare.fetch_add(static_cast<difference_type>(new_cap - cap), std::memory_order_relaxed);
+            }
+            catch (...)
+            {
+                unbook_failure_entry();
+                throw;
+            }
+        }
+
+        void unbook_failure_entry() noexcept { _failed_spare.fetch_add(1, std::memory_order_relaxed); }
+
+        // Records the slots in [first, last) as holding no object, so clear() skips them. Uses up the caller's booking
+        void record_failure(size_type first, size_type last) noexcept
+        {
+            if (first >= last)
+            {
+                unbook_failure_entry();
+                return;
+            }
+
+            std::scoped_lock lock{_failed_mutex};
+            const std::pair run{first, last};
+            _failed.insert(std::upper_bound(_failed.begin(), _failed.end(), run), run); // Within the booked capacity
+        }
+
+        void check_bounds(size_type pos) const
+        {
+            if (pos >= size())
+                throw std::out_of_range{std::format("concurrent_vector: index {} out of range of size {}", pos, size())};
+        }
+    };
+}
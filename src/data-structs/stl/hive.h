@@ -1,43 +1,328 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
 
 namespace mystl
 {
     struct hive_limits
     {
         std::size_t min, max;
-        hive_limits(std::size_t minimum, std::size_t maximum) noexcept :
+        constexpr hive_limits(std::size_t minimum, std::size_t maximum) noexcept :
             min{minimum}, max{maximum}
         {}
     };
 
+    // Smallest unsigned type that can hold max
+    template<std::size_t Max>
+    using hive_uint_for = std::conditional_t<Max <= UINT8_MAX, std::uint8_t,
+        std::conditional_t<Max <= UINT16_MAX, std::uint16_t,
+        std::conditional_t<Max <= UINT32_MAX, std::uint32_t, std::uint64_t>>>;
+
+    /*
+     * Skipfield policies decide how a hive block records which of its slots are erased. Both
+     * work on a block's skipfield array (storage_size(cap) entries, zeroed when the block is
+     * made) and the number of slots the block has used so far:
+     *     first(s, used)     -> first live slot
+     *     next(s, idx, used) -> first live slot after idx, or used if there is none
+     *     prev(s, idx)       -> last live slot before idx, or NONE
+     *     append(s, idx, n)  -> slots [idx, idx + n), idx == used, now hold elements
+     *     erase(s, idx)      -> slot idx no longer holds an element. Says whether it joined the
+     *                           erased runs to its left and right
+     *     revive(s, idx, n)  -> the first n slots of the erased run starting at idx hold elements
+     *                           again. Returns where the rest of the run now starts, or NONE
+     *     free_run_length(s, idx) -> how many slots revive can take from the run starting at idx
+     *     is_live(s, idx)    -> whether slot idx (< used) holds an element
+     *     run_end(s, idx, used) -> end of the run of live slots starting at idx
+     *
+     * Bitmap skipfields have no notion of runs: every erased slot stands on its own.
+     * The skipfield's value type, and so the memory spent on it, follows from the largest
+     * block capacity the policy has to support.
+     */
+    inline constexpr std::size_t HIVE_NO_SLOT = static_cast<std::size_t>(-1);
+
+    struct hive_skip_merge
+    {
+        bool left, right;
+    };
+
+    /*
+     * Low-complexity jump-counting skipfield, one value per slot. A run of consecutive erased
+     * slots (a skipblock) stores its length in its first and last slot, so iterating in either
+     * direction jumps over the whole run in O(1), and erasing only has to update the ends of
+     * at most two neighbouring runs. Live slots and unused ones read 0, erased ones never do.
+     */
+    template<std::size_t MaxBlockCapacity>
+    struct jump_counting_skipfield
+    {
+        using value_type = hive_uint_for<MaxBlockCapacity>;
+        static constexpr std::size_t max_block_capacity = MaxBlockCapacity;
+
+        // One extra entry stays 0, so that stepping onto slot cap stops there
+        static constexpr std::size_t storage_size(std::size_t cap) noexcept { return cap + 1; }
+
+        static std::size_t first(const value_type* s, std::size_t) noexcept { return s[0]; }
+
+        static std::size_t next(const value_type* s, std::size_t idx, std::size_t) noexcept
+        {
+            // Landing on an erased slot means landing on the start of a skipblock
+            ++idx;
+            return idx + s[idx];
+        }
+
+        static std::size_t prev(const value_type* s, std::size_t idx) noexcept
+        {
+            if (idx == 0)
+                return HIVE_NO_SLOT;
+
+            // Landing on an erased slot means landing on the end of a skipblock
+            --idx;
+            const std::size_t run = s[idx];
+            return run <= idx ? idx - run : HIVE_NO_SLOT;
+        }
+
+        static void append(value_type*, std::size_t, std::size_t = 1) noexcept {}
+
+        // Merges slot idx with the erased runs on either side
+        static hive_skip_merge erase(value_type* s, std::size_t idx) noexcept
+        {
+            const std::size_t left = idx > 0 ? s[idx - 1] : 0; // Length of the run ending just before idx
+            const std::size_t right = s[idx + 1];               // Length of the run starting just after idx
+
+            const auto start = idx - left;
+            const auto len = left + 1 + right;
+            s[idx] = static_cast<value_type>(len); // Only matters when idx ends up inside the run, to keep it nonzero
+            s[start] = static_cast<value_type>(len);
+            s[start + len - 1] = static_cast<value_type>(len);
+            return {left != 0, right != 0};
+        }
+
+        // Only the ends of a run are ever read when skipping, so shrinking it from the front only
+        // has to clear the revived slots (is_live reads them) and rewrite the new ends
+        static std::size_t revive(value_type* s, std::size_t idx, std::size_t n = 1) noexcept
+        {
+            const std::size_t len = s[idx];
+            std::fill_n(s + idx, n, value_type{0});
+            if (n == len)
+                return HIVE_NO_SLOT;
+
+            s[idx + n] = static_cast<value_type>(len - n);
+            s[idx + len - 1] = static_cast<value_type>(len - n);
+            return idx + n;
+        }
+
+        static std::size_t free_run_length(const value_type* s, std::size_t idx) noexcept { return s[idx]; }
+
+        static bool is_live(const value_type* s, std::size_t idx) noexcept { return s[idx] == 0; }
+
+        static std::size_t run_end(const value_type* s, std::size_t idx, std::size_t used) noexcept
+        {
+            while (idx < used && s[idx] == 0)
+                ++idx;
+            return idx;
+        }
+    };
+
+    /*
+     * One occupancy bit per slot, packed into 64-bit words. Costs 1 bit per element instead of
+     * a byte or two, but finding the next live slot scans words with countr_zero (tzcnt)
+     * rather than jumping, so long erased runs cost one step per 64 slots.
+     */
+    template<std::size_t MaxBlockCapacity>
+    struct bitmap_skipfield
+    {
+        using value_type = std::uint64_t;
+        static constexpr std::size_t max_block_capacity = MaxBlockCapacity;
+        static constexpr std::size_t WORD_BITS = 64;
+
+        static constexpr std::size_t storage_size(std::size_t cap) noexcept { return (cap + WORD_BITS - 1) / WORD_BITS; }
+
+        static std::size_t first(const value_type* s, std::size_t used) noexcept { return next(s, HIVE_NO_SLOT, used); }
+
+        static std::size_t next(const value_type* s, std::size_t idx, std::size_t used) noexcept
+        {
+            // Wraps around to 0 when called from first()
+            ++idx;
+            if (idx >= used)
+                return used;
+
+            // Unused slots never have their bit set, so the scan can't find anything past used
+            auto w = idx / WORD_BITS;
+            auto word = s[w] & (~value_type{0} << (idx % WORD_BITS));
+            while (word == 0)
+            {
+                if (++w * WORD_BITS >= used)
+                    return used;
+                word = s[w];
+            }
+            return w * WORD_BITS + std::countr_zero(word);
+        }
+
+        static std::size_t prev(const value_type* s, std::size_t idx) noexcept
+        {
+            if (idx == 0)
+                return HIVE_NO_SLOT;
+
+            --idx;
+            auto w = idx / WORD_BITS;
+            auto word = s[w] & (~value_type{0} >> (WORD_BITS - 1 - idx % WORD_BITS));
+            while (word == 0)
+            {
+                if (w == 0)
+                    return HIVE_NO_SLOT;
+                word = s[--w];
+            }
+            return w * WORD_BITS + (WORD_BITS - 1 - std::countl_zero(word));
+        }
+
+        // Sets the bits a word at a time
+        static void append(value_type* s, std::size_t idx, std::size_t n = 1) noexcept
+        {
+            while (n != 0)
+            {
+                const auto bit = idx % WORD_BITS;
+                const auto count = std::min(n, WORD_BITS - bit);
+                const auto mask = count == WORD_BITS ? ~value_type{0} : ((value_type{1} << count) - 1) << bit;
+                s[idx / WORD_BITS] |= mask;
+                idx += count;
+                n -= count;
+            }
+        }
+
+        static hive_skip_merge erase(value_type* s, std::size_t idx) noexcept
+        {
+            s[idx / WORD_BITS] &= ~(value_type{1} << (idx % WORD_BITS));
+            return {false, false};
+        }
+
+        static std::size_t revive(value_type* s, std::size_t idx, std::size_t n = 1) noexcept
+        {
+            append(s, idx, n);
+            return HIVE_NO_SLOT;
+        }
+
+        // Erased slots are listed one by one
+        static std::size_t free_run_length(const value_type*, std::size_t) noexcept { return 1; }
+
+        static bool is_live(const value_type* s, std::size_t idx) noexcept { return (s[idx / WORD_BITS] >> (idx % WORD_BITS)) & 1; }
+
+        // Counts the trailing ones (the live slots) a word at a time
+        static std::size_t run_end(const value_type* s, std::size_t idx, std::size_t used) noexcept
+        {
+            while (idx < used)
+            {
+                const auto ones = static_cast<std::size_t>(std::countr_one(s[idx / WORD_BITS] >> (idx % WORD_BITS)));
+                const auto left_in_word = WORD_BITS - idx % WORD_BITS;
+                idx += std::min(ones, left_in_word);
+                if (ones < left_in_word)
+                    break;
+            }
+            return std::min(idx, used);
+        }
+    };
+
+    // Small elements get a 1 byte skipfield (blocks of up to 255), others 2 bytes (up to 65535)
+    template<typename T>
+    using default_hive_skipfield = jump_counting_skipfield<sizeof(T) <= 10 ? UINT8_MAX : UINT16_MAX>;
+
+    /*
+     * Execution policies for the parallel hive algorithms, named after std::execution's. Those
+     * aren't used since libstdc++ needs TBB linked to run them.
+     */
+    namespace execution
+    {
+        struct sequenced_policy {};
+
+        struct parallel_policy
+        {
+            unsigned threads = 0; // At most this many threads, 0 for one per hardware thread
+
+            unsigned thread_count() const noexcept { return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()); }
+        };
+
+        inline constexpr sequenced_policy seq{};
+        inline constexpr parallel_policy par{};
+    }
+
+    /*
+     * Bucket-array container (P0447): elements live in a linked list of blocks that grow in
+     * capacity, so inserting never moves an element and pointers/iterators stay valid until
+     * the element itself is erased.
+     *
+     * Erased slots are marked in each block's skipfield, kept as the Skipfield policy says
+     * (see above). Its value type bounds the block capacity limits.
+     *
+     * Erased slots are reused before the hive grows. Each block threads its erased runs into a
+     * free list whose links live in the dead slots themselves, and blocks with a non-empty free
+     * list are chained together, so insert finds a hole in O(1). A block whose last element is
+     * erased goes to a pool of unused blocks (as do blocks from reserve()), which insert draws
+     * on before allocating.
+     *
+     * Inserting many elements at once fills the holes a whole erased run at a time, then puts
+     * the rest at the back in blocks sized for them (within the block capacity limits).
+     *
+     * Memory only goes back to the allocator when asked: trim_capacity() frees the pool, and
+     * shrink_to_fit() first compacts, moving elements out of sparse blocks. Compaction (and
+     * reshape(), when a block no longer fits the limits) is the only thing that moves elements.
+     *
+     * splice() takes over another hive's blocks by relinking them, and sort() moves the
+     * elements so that iteration visits them in order.
+     *
+     * For parallel loops, partition() splits the blocks into runs holding about the same number
+     * of elements, one per thread. for_each and transform_reduce (below the class) take an
+     * execution policy and run over those.
+     */
     template<
         typename T,
-        typename Allocator = std::allocator<T>
+        typename Allocator = std::allocator<T>,
+        typename Skipfield = default_hive_skipfield<T>
     >
     class hive
     {
     private:
         using alloc_traits = std::allocator_traits<Allocator>;
 
-        struct block
+        // Slots are indexed with the smallest type that fits a block, saving the largest value for "none"
+        using index_type = hive_uint_for<Skipfield::max_block_capacity>;
+        static constexpr index_type NO_INDEX = std::numeric_limits<index_type>::max();
+
+        // Links of an erased slot in its block's free list
+        struct free_links
         {
-            pointer data;
-            skipfield_pointer skip;
-            size_type cap, sz;
-            block_pointer prev, next;
-            block_pointer next_w_space; // Next block with free space
-
-            block(allocator_type alloc, skipfield_allocator_type skipfield_alloc, size_type capacity, block_pointer prev = nullptr) :
-                data{alloc_traits::allocate(alloc, capacity)},
-                skip{skipfield_alloc_traits::allocate(skipfield_alloc, capacity)},
-                cap{capacity}, sz{0},
-                prev{prev}, next{nullptr},
-                next_w_space{nullptr}
-            {}
+            index_type prev, next;
         };
 
+        // Storage for one element, reused for free list links while the element is erased
+        union slot
+        {
+            T value;
+            free_links links;
+
+            slot() noexcept {}
+            ~slot() {}
+        };
+
+        struct block;
+
     public:
         using value_type = T;
         using allocator_type = Allocator;
@@ -46,72 +331,1211 @@ namespace mystl
         using reference = value_type&;
         using const_reference = const value_type&;
         using size_type = std::size_t;
-        // TODO: Define the iterator-related types
-        //using difference_type = // This is the diff type of iterator & const_iterator
-        //using iterator = 
-        //using const_iterator = 
-        //using reverse_iterator = 
-        //using const_reverse_iterator = 
-
-        hive() noexcept(noexcept(Allocator)) : hive(Allocator()) {}
-        explicit hive(const Allocator& alloc) :
-            _alloc{alloc}, _limits{MIN_LIMIT, MAX_LIMIT},
-            _blocks{nullptr}, _blocks_w_space{nullptr}, _nx_block_sz{MIN_LIMIT}
+        using difference_type = std::ptrdiff_t;
+
+        template<bool Const>
+        class hive_iterator
+        {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = hive::value_type;
+            using difference_type = hive::difference_type;
+            using reference = std::conditional_t<Const, const value_type&, value_type&>;
+            using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+            hive_iterator() noexcept = default;
+
+            // Allow iterator -> const_iterator
+            template<bool OtherConst>
+                requires (Const && !OtherConst)
+            hive_iterator(const hive_iterator<OtherConst>& other) noexcept :
+                _block{other._block}, _idx{other._idx}
+            {}
+
+            reference operator*() const noexcept { return _block->data[_idx].value; }
+            pointer operator->() const noexcept { return std::addressof(_block->data[_idx].value); }
+
+            hive_iterator& operator++() noexcept
+            {
+                _idx = Skipfield::next(std::to_address(_block->skip), _idx, _block->used);
+                if (_idx == _block->used && _block->next != nullptr)
+                {
+                    _block = _block->next;
+                    _idx = _block->first();
+                }
+                return *this;
+            }
+            hive_iterator operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+            hive_iterator& operator--() noexcept
+            {
+                // Every block holds an element, so this moves back at most one block
+                auto prev = Skipfield::prev(std::to_address(_block->skip), _idx);
+                if (prev == HIVE_NO_SLOT)
+                {
+                    _block = _block->prev;
+                    prev = Skipfield::prev(std::to_address(_block->skip), _block->used);
+                }
+                _idx = prev;
+                return *this;
+            }
+            hive_iterator operator--(int) noexcept { auto tmp = *this; --*this; return tmp; }
+
+            friend bool operator==(const hive_iterator& a, const hive_iterator& b) noexcept
+            {
+                return a._block == b._block && a._idx == b._idx;
+            }
+
+        private:
+            friend class hive;
+            friend class hive_iterator<!Const>;
+
+            block* _block = nullptr;
+            size_type _idx = 0;
+
+            hive_iterator(block* b, size_type idx) noexcept : _block{b}, _idx{idx} {}
+        };
+
+        using iterator = hive_iterator<false>;
+        using const_iterator = hive_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        /*
+         * A block's elements as a plain array, for loops that would rather run straight over
+         * memory than through the skipping iterator. data() spans every slot the block has
+         * used, erased ones included, and those must not be touched. A full() block has none,
+         * so its whole span can go through one tight, vectorisable loop. Otherwise
+         * for_each_run() hands out the spans of consecutive live elements, or is_live() (and
+         * occupancy(), with a bitmap skipfield) can drive a masked loop.
+         */
+        template<bool Const>
+        class basic_block_view
+        {
+        public:
+            using element_type = std::conditional_t<Const, const T, T>;
+
+            std::span<element_type> data() const noexcept
+            {
+                return {reinterpret_cast<element_type*>(std::to_address(_block->data)), _block->used};
+            }
+
+            size_type size() const noexcept { return _block->sz; }
+            size_type capacity() const noexcept { return _block->cap; }
+            bool full() const noexcept { return _block->sz == _block->used; }
+            bool is_live(size_type idx) const noexcept { return Skipfield::is_live(std::to_address(_block->skip), idx); }
+
+            template<typename F>
+            void for_each_run(F f) const
+            {
+                const auto s = std::to_address(_block->skip);
+                const auto used = _block->used;
+                for (auto start = Skipfield::first(s, used); start < used; )
+                {
+                    const auto end = Skipfield::run_end(s, start, used);
+                    f(data().subspan(start, end - start));
+                    start = Skipfield::next(s, end - 1, used);
+                }
+            }
+
+            // Bit i % 64 of word i / 64 is set if slot i is live
+            std::span<const std::uint64_t> occupancy() const noexcept
+                requires std::is_same_v<Skipfield, bitmap_skipfield<Skipfield::max_block_capacity>>
+            {
+                return {std::to_address(_block->skip), Skipfield::storage_size(_block->used)};
+            }
+
+        private:
+            friend class hive;
+
+            const block* _block;
+
+            explicit basic_block_view(const block* b) noexcept : _block{b} {}
+        };
+
+        using block_view = basic_block_view<false>;
+        using const_block_view = basic_block_view<true>;
+
+        // A run of whole blocks, as made by partition()
+        using range = std::ranges::subrange<iterator, iterator, std::ranges::subrange_kind::sized>;
+        using const_range = std::ranges::subrange<const_iterator, const_iterator, std::ranges::subrange_kind::sized>;
+
+        template<typename Range>
+        using range_vector = vector<Range, typename alloc_traits::template rebind_alloc<Range>>;
+
+        // Constructors
+        /**********************************************************************/
+        hive() noexcept(noexcept(Allocator())) : hive(Allocator()) {}
+
+        explicit hive(const Allocator& alloc) noexcept :
+            hive(hive_limits{MIN_LIMIT, MAX_LIMIT}, alloc)
+        {}
+
+        explicit hive(hive_limits limits, const Allocator& alloc = Allocator()) :
+            _alloc{alloc}, _slot_alloc{_alloc}, _block_alloc{_alloc}, _skipfield_alloc{_alloc},
+            _limits{checked_limits(limits)}, _nx_block_sz{_limits.min}
         {}
 
+        hive(size_type count, const T& value, hive_limits limits = {MIN_LIMIT, MAX_LIMIT}, const Allocator& alloc = Allocator()) :
+            hive(limits, alloc)
+        {
+            insert(count, value);
+        }
+
+        explicit hive(size_type count, hive_limits limits = {MIN_LIMIT, MAX_LIMIT}, const Allocator& alloc = Allocator()) :
+            hive(limits, alloc)
+        {
+            insert_n(count, [this](T* p) { alloc_traits::construct(_alloc, p); });
+        }
+
+        template<std::input_iterator InputIt>
+        hive(InputIt first, InputIt last, hive_limits limits = {MIN_LIMIT, MAX_LIMIT}, const Allocator& alloc = Allocator()) :
+            hive(limits, alloc)
+        {
+            insert(first, last);
+        }
+
+        hive(std::initializer_list<T> init, hive_limits limits = {MIN_LIMIT, MAX_LIMIT}, const Allocator& alloc = Allocator()) :
+            hive(init.begin(), init.end(), limits, alloc)
+        {}
+
+        hive(const hive& other) :
+            hive(other.begin(), other.end(), other._limits, alloc_traits::select_on_container_copy_construction(other.get_allocator()))
+        {}
+
+        hive(hive&& other) noexcept :
+            _alloc{std::move(other._alloc)}, _slot_alloc{_alloc}, _block_alloc{_alloc}, _skipfield_alloc{_alloc},
+            _limits{other._limits},
+            _blocks{std::exchange(other._blocks, nullptr)},
+            _last_block{std::exchange(other._last_block, nullptr)},
+            _blocks_w_space{std::exchange(other._blocks_w_space, nullptr)},
+            _unused_blocks{std::exchange(other._unused_blocks, nullptr)},
+            _sz{std::exchange(other._sz, 0)},
+            _cap{std::exchange(other._cap, 0)},
+            _nx_block_sz{std::exchange(other._nx_block_sz, other._limits.min)}
+        {}
+        /**********************************************************************/
+
         ~hive()
         {
-            // TODO: Destroy elements & deallocate blocks (and data inside)
+            clear();
+            free_unused_blocks();
+        }
+
+        // Assignments
+        /**********************************************************************/
+        hive& operator=(const hive& other)
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+            {
+                // The pooled blocks belong to the old allocator
+                if (_alloc != other._alloc)
+                    free_unused_blocks();
+                set_allocator(other._alloc);
+            }
+
+            insert(other.begin(), other.end());
+            return *this;
+        }
+
+        hive& operator=(hive&& other)
+            noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+            if constexpr (!alloc_traits::propagate_on_container_move_assignment::value && !alloc_traits::is_always_equal::value)
+            {
+                if (_alloc != other._alloc)
+                {
+                    // Not allowed to take other's allocator, so its blocks can't be taken either
+                    for (auto& elem : other)
+                        emplace(std::move(elem));
+                    other.clear();
+                    return *this;
+                }
+            }
+
+            free_unused_blocks();
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+                set_allocator(std::move(other._alloc));
+
+            _limits = other._limits;
+            _blocks = std::exchange(other._blocks, nullptr);
+            _last_block = std::exchange(other._last_block, nullptr);
+            _blocks_w_space = std::exchange(other._blocks_w_space, nullptr);
+            _unused_blocks = std::exchange(other._unused_blocks, nullptr);
+            _sz = std::exchange(other._sz, 0);
+            _cap = std::exchange(other._cap, 0);
+            _nx_block_sz = std::exchange(other._nx_block_sz, other._limits.min);
+            return *this;
+        }
+
+        hive& operator=(std::initializer_list<T> init)
+        {
+            assign(init.begin(), init.end());
+            return *this;
+        }
+
+        template<std::input_iterator InputIt>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            insert(first, last);
+        }
+
+        void assign(size_type count, const T& value)
+        {
+            clear();
+            insert(count, value);
+        }
+
+        void assign(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+        /**********************************************************************/
+
+        // Iterators
+        /**********************************************************************/
+        iterator begin() noexcept { return _blocks ? iterator{_blocks, _blocks->first()} : iterator{}; }
+        const_iterator begin() const noexcept { return _blocks ? const_iterator{_blocks, _blocks->first()} : const_iterator{}; }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return _last_block ? iterator{_last_block, _last_block->used} : iterator{}; }
+        const_iterator end() const noexcept { return _last_block ? const_iterator{_last_block, _last_block->used} : const_iterator{}; }
+        const_iterator cend() const noexcept { return end(); }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+        // Iterator to the element p points to, or end() if p isn't an element of this hive. O(blocks)
+        iterator get_iterator(const_pointer p) noexcept
+        {
+            const auto elem = reinterpret_cast<const std::byte*>(std::to_address(p));
+            for (auto b = _blocks; b != nullptr; b = b->next)
+            {
+                const auto first = reinterpret_cast<const std::byte*>(std::to_address(b->data));
+                if (std::less_equal<>{}(first, elem) && std::less<>{}(elem, first + b->used * sizeof(slot)))
+                    return {b, static_cast<size_type>(elem - first) / sizeof(slot)};
+            }
+            return end();
         }
+        const_iterator get_iterator(const_pointer p) const noexcept { return const_cast<hive*>(this)->get_iterator(p); }
+        /**********************************************************************/
 
+        // Modifiers
+        /**********************************************************************/
         template<typename... Args>
         iterator emplace(Args&&... args)
         {
-            // TODO: Implement
+            if (_blocks_w_space != nullptr)
+            {
+                // Fill a hole left by an erase
+                const auto b = _blocks_w_space;
+                const auto idx = b->free_head;
+                take_free(b, idx);
+                try
+                {
+                    alloc_traits::construct(_alloc, std::addressof(b->data[idx].value), std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    make_free(b, idx);
+                    throw;
+                }
+
+                ++b->sz;
+                ++_sz;
+                return {b, idx};
+            }
+
+            const auto b = tail_block(_nx_block_sz);
+            const auto idx = b->used;
+            try
+            {
+                alloc_traits::construct(_alloc, std::addressof(b->data[idx].value), std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                // Blocks are never left empty
+                if (b->sz == 0)
+                    retire_block(b);
+                throw;
+            }
+
+            Skipfield::append(std::to_address(b->skip), idx);
+            ++b->used;
+            ++b->sz;
+            ++_sz;
+            return {b, idx};
         }
-        iterator insert(const T& value)
+        iterator insert(const T& value) { return emplace(value); }
+        iterator insert(T&& value) { return emplace(std::move(value)); }
+
+        void insert(size_type count, const T& value)
         {
-            // TODO: Implement
+            insert_n(count, [this, &value](T* p) { alloc_traits::construct(_alloc, p, value); });
         }
-        iterator insert(T&& value)
+
+        // Forward ranges are counted first so they can go in as a batch; others go one by one
+        template<std::input_iterator InputIt>
+        void insert(InputIt first, InputIt last)
         {
-            // TODO: Implement
+            if constexpr (std::forward_iterator<InputIt>)
+            {
+                insert_n(static_cast<size_type>(std::distance(first, last)), [this, &first](T* p)
+                {
+                    alloc_traits::construct(_alloc, p, *first);
+                    ++first;
+                });
+            }
+            else
+            {
+                for (; first != last; ++first)
+                    emplace(*first);
+            }
         }
 
+        void insert(std::initializer_list<T> init) { insert(init.begin(), init.end()); }
+
+        template<std::ranges::input_range R>
+        void insert_range(R&& range)
+        {
+            if constexpr (std::ranges::sized_range<R> || std::ranges::forward_range<R>)
+            {
+                auto it = std::ranges::begin(range);
+                insert_n(static_cast<size_type>(std::ranges::distance(range)), [this, &it](T* p)
+                {
+                    alloc_traits::construct(_alloc, p, *it);
+                    ++it;
+                });
+            }
+            else
+            {
+                for (auto&& elem : range)
+                    emplace(std::forward<decltype(elem)>(elem));
+            }
+        }
+
+        // Returns the iterator following the erased element
+        iterator erase(const_iterator pos)
+        {
+            auto b = pos._block;
+            const auto idx = pos._idx;
+
+            alloc_traits::destroy(_alloc, std::addressof(b->data[idx].value));
+            --_sz;
+
+            if (--b->sz == 0)
+            {
+                // Nothing left to skip over, the block goes back to the pool
+                const auto next = b->next;
+                retire_block(b);
+                return next != nullptr ? iterator{next, next->first()} : end();
+            }
+
+            // Step off before the skipfield changes under the slot
+            iterator next{b, idx};
+            ++next;
+            make_free(b, idx);
+            return next;
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            // end() moves if erasing frees the last block, so it can't be compared against directly
+            if (last == cend())
+            {
+                while (first != cend())
+                    first = erase(first);
+                return end();
+            }
+
+            while (first != last)
+                first = erase(first);
+            return {last._block, last._idx};
+        }
+
+        // Destroys every element. The blocks are kept in the pool, so capacity() doesn't change
+        void clear() noexcept
+        {
+            while (_blocks != nullptr)
+            {
+                const auto b = _blocks;
+                for (auto it = iterator{b, b->first()}; it._block == b && it._idx != b->used; ++it)
+                    alloc_traits::destroy(_alloc, std::addressof(b->data[it._idx].value));
+
+                _blocks = b->next;
+                pool_block(b);
+            }
+
+            _last_block = nullptr;
+            _blocks_w_space = nullptr;
+            _sz = 0;
+        }
+
+        void swap(hive& other)
+            noexcept(alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value)
+        {
+            if constexpr (alloc_traits::propagate_on_container_swap::value)
+            {
+                std::swap(_alloc, other._alloc);
+                std::swap(_slot_alloc, other._slot_alloc);
+                std::swap(_block_alloc, other._block_alloc);
+                std::swap(_skipfield_alloc, other._skipfield_alloc);
+            }
+
+            std::swap(_limits, other._limits);
+            std::swap(_blocks, other._blocks);
+            std::swap(_last_block, other._last_block);
+            std::swap(_blocks_w_space, other._blocks_w_space);
+            std::swap(_unused_blocks, other._unused_blocks);
+            std::swap(_sz, other._sz);
+            std::swap(_cap, other._cap);
+            std::swap(_nx_block_sz, other._nx_block_sz);
+        }
+        /**********************************************************************/
+
+        // Operations
+        /**********************************************************************/
+        /*
+         * Moves all of other's elements into this hive by relinking its blocks, O(blocks of
+         * other). No element moves, so iterators and pointers to them stay valid but now belong
+         * to this hive. other keeps its pooled blocks. The allocators must compare equal. Throws
+         * length_error, leaving both hives alone, if one of other's blocks is outside this
+         * hive's block capacity limits.
+         */
+        void splice(hive& other)
+        {
+            if (this == &other || other._blocks == nullptr)
+                return;
+
+            size_type moved_cap = 0;
+            for (auto b = other._blocks; b != nullptr; b = b->next)
+            {
+                if (b->cap < _limits.min || b->cap > _limits.max)
+                    throw std::length_error{std::format("hive: cannot splice a block of {} elements into limits [{}, {}]", b->cap, _limits.min, _limits.max)};
+                moved_cap += b->cap;
+            }
+
+            if (_blocks == nullptr)
+            {
+                _blocks = other._blocks;
+                _last_block = other._last_block;
+            }
+            else if (_last_block->cap - _last_block->used >= other._last_block->cap - other._last_block->used)
+            {
+                // Only the last block's never-used slots get filled, so whichever has more of them stays last
+                other._last_block->next = _blocks;
+                _blocks->prev = other._last_block;
+                _blocks = other._blocks;
+            }
+            else
+            {
+                _last_block->next = other._blocks;
+                other._blocks->prev = _last_block;
+                _last_block = other._last_block;
+            }
+
+            if (other._blocks_w_space != nullptr)
+            {
+                auto tail = other._blocks_w_space;
+                while (tail->next_w_space != nullptr)
+                    tail = tail->next_w_space;
+                tail->next_w_space = _blocks_w_space;
+                if (_blocks_w_space != nullptr)
+                    _blocks_w_space->prev_w_space = tail;
+                _blocks_w_space = other._blocks_w_space;
+            }
+
+            _sz += std::exchange(other._sz, 0);
+            _cap += moved_cap;
+            other._cap -= moved_cap;
+            other._blocks = other._last_block = other._blocks_w_space = nullptr;
+        }
+
+        void splice(hive&& other) { splice(other); }
+
+        /*
+         * Sorts an array of indices into the elements, then moves the elements along the cycles of
+         * that permutation (through one temporary) so iteration visits them in order. Values move
+         * between slots, so iterators and pointers keep their place but see whatever value sorted
+         * into it. If comp throws nothing has moved; if a move throws the elements are left valid
+         * but in an unspecified order.
+         */
+        template<typename Compare = std::less<>>
+        void sort(Compare comp = Compare{})
+        {
+            if (_sz < 2)
+                return;
+
+            using pointer_allocator_type = typename alloc_traits::template rebind_alloc<T*>;
+            using index_allocator_type = typename alloc_traits::template rebind_alloc<size_type>;
+
+            vector<T*, pointer_allocator_type> elems{pointer_allocator_type{_alloc}};
+            elems.reserve(_sz);
+            for (auto& elem : *this)
+                elems.push_back(std::addressof(elem));
+
+            // The element that belongs at position i is the one now at order[i]
+            vector<size_type, index_allocator_type> order(_sz, index_allocator_type{_alloc});
+            std::iota(order.begin(), order.end(), size_type{0});
+            std::sort(order.begin(), order.end(), [&elems, &comp](size_type a, size_type b) { return comp(*elems[a], *elems[b]); });
+
+            for (size_type start = 0; start < _sz; ++start)
+            {
+                if (order[start] == start)
+                    continue;
+
+                T tmp = std::move(*elems[start]);
+                auto i = start;
+                while (order[i] != start)
+                {
+                    *elems[i] = std::move(*elems[order[i]]);
+                    i = std::exchange(order[i], i);
+                }
+                *elems[i] = std::move(tmp);
+                order[i] = i;
+            }
+        }
+        /**********************************************************************/
+
+        /*
+         * Calls f(view) with a block_view of each block, in iteration order. Only there when the
+         * elements are stored back to back, which takes a T at least as large as the free list
+         * links an erased slot holds (two slot indices, so hive<char> has no block views).
+         */
+        template<typename F>
+        void for_each_block(F f) requires (sizeof(slot) == sizeof(T))
+        {
+            for (auto b = _blocks; b != nullptr; b = b->next)
+                f(block_view{b});
+        }
+
+        template<typename F>
+        void for_each_block(F f) const requires (sizeof(slot) == sizeof(T))
+        {
+            for (auto b = _blocks; b != nullptr; b = b->next)
+                f(const_block_view{b});
+        }
+
+        /*
+         * Splits the hive into at most parts ranges of consecutive blocks, each holding about
+         * size() / parts elements, for threads to work on side by side. A block is never split,
+         * so a hive with few (or very uneven) blocks gives fewer ranges. Any insert or erase
+         * invalidates them.
+         */
+        range_vector<range> partition(size_type parts) { return partition_as<range>(parts); }
+        range_vector<const_range> partition(size_type parts) const { return const_cast<hive*>(this)->partition_as<const_range>(parts); }
+
+        /*
+         * Calls f(range, i) for each range i of a partition, on up to policy.threads threads (the
+         * caller's included). Small hives stay on the calling thread. If any call throws, one of
+         * the exceptions is rethrown once every thread is done.
+         */
+        template<typename F>
+        void for_each_range(execution::parallel_policy policy, F f) { run_on_threads(partition(policy.thread_count()), f); }
+
+        template<typename F>
+        void for_each_range(execution::parallel_policy policy, F f) const { run_on_threads(partition(policy.thread_count()), f); }
+        /**********************************************************************/
+
+        // Capacity
+        /**********************************************************************/
+        bool empty() const noexcept { return _sz == 0; }
+        size_type size() const noexcept { return _sz; }
+        size_type max_size() const noexcept { return std::numeric_limits<difference_type>::max() / sizeof(T); }
+        size_type capacity() const noexcept { return _cap; }
+
+        // Allocates unused blocks until capacity() reaches new_cap
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > max_size())
+                throw std::length_error{std::format("hive: cannot reserve {} elements, max_size() is {}", new_cap, max_size())};
+
+            while (_cap < new_cap)
+            {
+                const auto b = create_block(std::clamp(new_cap - _cap, _limits.min, _limits.max));
+                _cap += b->cap;
+                pool_block(b);
+            }
+        }
+
+        // Frees the pooled blocks. Elements stay where they are
+        void trim_capacity() noexcept { free_unused_blocks(); }
+
+        // Frees pooled blocks until capacity() is at most n, or the pool runs out
+        void trim_capacity(size_type n) noexcept
+        {
+            while (_cap > n && _unused_blocks != nullptr)
+                destroy_block(std::exchange(_unused_blocks, _unused_blocks->next));
+        }
+
+        /*
+         * Compacts, then frees the pooled blocks. Starting with the sparsest block, elements are
+         * moved into the free slots of the densest ones for as long as a whole block's worth
+         * fits, and the blocks this empties are freed. Iterators, pointers and references to the
+         * moved elements are invalidated.
+         */
+        void shrink_to_fit()
+        {
+            compact();
+            free_unused_blocks();
+        }
+
+        hive_limits block_capacity_limits() const noexcept { return _limits; }
+
+        /*
+         * Changes the block capacity limits. Pooled blocks outside them are freed. If a block
+         * holding elements is outside them, all elements move into new blocks, which
+         * invalidates every iterator, pointer and reference.
+         */
+        void reshape(hive_limits limits)
+        {
+            limits = checked_limits(limits);
+            const auto fits = [&limits](const block* b) { return limits.min <= b->cap && b->cap <= limits.max; };
+
+            for (auto p = &_unused_blocks; *p != nullptr; )
+            {
+                if (fits(*p))
+                {
+                    p = &(*p)->next;
+                    continue;
+                }
+                const auto b = *p;
+                *p = b->next;
+                destroy_block(b);
+            }
+
+            for (auto b = _blocks; b != nullptr; b = b->next)
+            {
+                if (fits(b))
+                    continue;
+
+                // Builds the new layout on the side, so nothing changes if an element throws
+                hive tmp(limits, _alloc);
+                tmp.insert_n(_sz, [&tmp, it = begin()](T* p) mutable
+                {
+                    alloc_traits::construct(tmp._alloc, p, std::move_if_noexcept(*it));
+                    ++it;
+                });
+                free_unused_blocks();
+                swap(tmp);
+                return;
+            }
+
+            _limits = limits;
+            _nx_block_sz = std::clamp(_nx_block_sz, limits.min, limits.max);
+        }
+        static constexpr hive_limits block_capacity_hard_limits() noexcept { return {1, MAX_LIMIT}; }
+        /**********************************************************************/
+
+        allocator_type get_allocator() const noexcept { return _alloc; }
+
     private:
+        using slot_allocator_type = typename alloc_traits::template rebind_alloc<slot>;
         using block_allocator_type = typename alloc_traits::template rebind_alloc<block>;
-        using skipfield_allocator_type = typename alloc_traits::template rebind_alloc<size_type>;
+        using skipfield_type = typename Skipfield::value_type;
+        using skipfield_allocator_type = typename alloc_traits::template rebind_alloc<skipfield_type>;
 
+        using slot_alloc_traits = std::allocator_traits<slot_allocator_type>;
         using block_alloc_traits = std::allocator_traits<block_allocator_type>;
         using skipfield_alloc_traits = std::allocator_traits<skipfield_allocator_type>;
 
-        using block_pointer = block_alloc_traits::pointer;
+        using slot_pointer = slot_alloc_traits::pointer;
         using skipfield_pointer = skipfield_alloc_traits::pointer;
 
-        constexpr size_type GROWTH_FACTOR = 2;
-        constexpr size_type MIN_LIMIT = 8, MAX_LIMIT = std::numeric_limits<size_type>::max();
+        struct block
+        {
+            slot_pointer data;
+            skipfield_pointer skip; // Skipfield::storage_size(cap) entries
+            size_type cap;
+            size_type sz;           // Live elements
+            size_type used;         // Slots [0, used) hold live or erased elements, the rest were never used
+            index_type free_head;   // First erased run (or slot, with a bitmap) free for reuse, NO_INDEX if none
+            block* prev;
+            block* next;
+            block* prev_w_space;    // Chain of blocks whose free list isn't empty
+            block* next_w_space;
+
+            size_type first() const noexcept { return Skipfield::first(std::to_address(skip), used); }
+        };
+
+        static constexpr size_type GROWTH_FACTOR = 2;
+        static constexpr size_type MAX_LIMIT = Skipfield::max_block_capacity;
+        static constexpr size_type MIN_LIMIT = std::min<size_type>(8, MAX_LIMIT);
 
         allocator_type _alloc;
+        slot_allocator_type _slot_alloc;
         block_allocator_type _block_alloc;
         skipfield_allocator_type _skipfield_alloc;
         hive_limits _limits;
-        block* _blocks, _blocks_w_space;
+        block* _blocks = nullptr;
+        block* _last_block = nullptr;
+        block* _blocks_w_space = nullptr;
+        block* _unused_blocks = nullptr; // Pool of empty blocks, linked through next
+        size_type _sz = 0;
+        size_type _cap = 0;
         size_type _nx_block_sz;
 
-        // Gets the next free element in the mem. blocks. Allocs a new block if every block is full
-        iterator get_free_elem()
+        static hive_limits checked_limits(hive_limits limits)
+        {
+            const auto hard = block_capacity_hard_limits();
+            if (limits.min > limits.max || limits.min < hard.min || limits.max > hard.max)
+                throw std::length_error{std::format("hive: block capacity limits [{}, {}] outside of [{}, {}]", limits.min, limits.max, hard.min, hard.max)};
+            return limits;
+        }
+
+        void set_allocator(allocator_type alloc)
+        {
+            _alloc = std::move(alloc);
+            _slot_alloc = slot_allocator_type{_alloc};
+            _block_alloc = block_allocator_type{_alloc};
+            _skipfield_alloc = skipfield_allocator_type{_alloc};
+        }
+
+        block* create_block(size_type cap)
+        {
+            const auto data = slot_alloc_traits::allocate(_slot_alloc, cap);
+            skipfield_pointer skip{};
+            block* b = nullptr;
+            try
+            {
+                skip = skipfield_alloc_traits::allocate(_skipfield_alloc, Skipfield::storage_size(cap));
+                b = std::to_address(block_alloc_traits::allocate(_block_alloc, 1));
+            }
+            catch (...)
+            {
+                if (skip != nullptr)
+                    skipfield_alloc_traits::deallocate(_skipfield_alloc, skip, Skipfield::storage_size(cap));
+                slot_alloc_traits::deallocate(_slot_alloc, data, cap);
+                throw;
+            }
+
+            std::uninitialized_fill_n(std::to_address(skip), Skipfield::storage_size(cap), skipfield_type{0});
+            return std::construct_at(b, block{data, skip, cap, 0, 0, NO_INDEX, nullptr, nullptr, nullptr, nullptr});
+        }
+
+        void destroy_block(block* b) noexcept
+        {
+            _cap -= b->cap;
+            skipfield_alloc_traits::deallocate(_skipfield_alloc, b->skip, Skipfield::storage_size(b->cap));
+            slot_alloc_traits::deallocate(_slot_alloc, b->data, b->cap);
+            std::destroy_at(b);
+            block_alloc_traits::deallocate(_block_alloc, b, 1);
+        }
+
+        // Resets a block that holds no elements and puts it in the pool
+        void pool_block(block* b) noexcept
+        {
+            std::fill_n(std::to_address(b->skip), Skipfield::storage_size(b->cap), skipfield_type{0});
+            b->sz = b->used = 0;
+            b->free_head = NO_INDEX;
+            b->prev = b->prev_w_space = b->next_w_space = nullptr;
+            b->next = _unused_blocks;
+            _unused_blocks = b;
+        }
+
+        void free_unused_blocks() noexcept
+        {
+            while (_unused_blocks != nullptr)
+                destroy_block(std::exchange(_unused_blocks, _unused_blocks->next));
+        }
+
+        // Unlinks a block whose last element was erased and pools it
+        void retire_block(block* b) noexcept
+        {
+            if (b->free_head != NO_INDEX)
+                unlink_w_space(b);
+            (b->prev != nullptr ? b->prev->next : _blocks) = b->next;
+            (b->next != nullptr ? b->next->prev : _last_block) = b->prev;
+            pool_block(b);
+        }
+
+        /*
+         * Gets the last block, whose never-used slots from used onwards are free. If it is full a
+         * new one goes at the back: a pooled block if there is one, otherwise one of at least
+         * wanted (a capacity within the limits) and _nx_block_sz, which grows past it.
+         */
+        block* tail_block(size_type wanted)
+        {
+            if (_last_block == nullptr || _last_block->used == _last_block->cap)
+            {
+                block* new_block;
+                if (_unused_blocks != nullptr)
+                {
+                    new_block = std::exchange(_unused_blocks, _unused_blocks->next);
+                }
+                else
+                {
+                    new_block = create_block(std::max(wanted, _nx_block_sz));
+                    _cap += new_block->cap;
+                    _nx_block_sz = new_block->cap <= _limits.max / GROWTH_FACTOR ? new_block->cap * GROWTH_FACTOR : _limits.max;
+                }
+
+                new_block->prev = _last_block;
+                new_block->next = nullptr;
+                (_last_block != nullptr ? _last_block->next : _blocks) = new_block;
+                _last_block = new_block;
+            }
+
+            return _last_block;
+        }
+
+        /*
+         * Inserts count elements, built in place by construct(T*). Holes are filled first, each
+         * erased run with one skipfield update, then the rest go at the back a block at a time.
+         * If construct throws, the elements built so far stay and the slots of the rest are
+         * freed again.
+         */
+        template<typename Construct>
+        void insert_n(size_type count, Construct construct)
+        {
+            if (count > max_size() - _sz)
+                throw std::length_error{std::format("hive: cannot insert {} elements into {}, max_size() is {}", count, _sz, max_size())};
+
+            while (count != 0 && _blocks_w_space != nullptr)
+            {
+                const auto b = _blocks_w_space;
+                const auto idx = b->free_head;
+                const auto n = std::min(count, Skipfield::free_run_length(std::to_address(b->skip), idx));
+                take_free(b, idx, n);
+
+                size_type built = 0;
+                try
+                {
+                    for (; built < n; ++built)
+                        construct(std::addressof(b->data[idx + built].value));
+                }
+                catch (...)
+                {
+                    b->sz += built;
+                    _sz += built;
+                    for (auto i = idx + n; i-- > idx + built; )
+                        make_free(b, i);
+                    throw;
+                }
+
+                b->sz += n;
+                _sz += n;
+                count -= n;
+            }
+
+            while (count != 0)
+            {
+                const auto b = tail_block(std::clamp(count, _limits.min, _limits.max));
+                const auto idx = b->used;
+                const auto n = std::min(count, b->cap - idx);
+
+                size_type built = 0;
+                try
+                {
+                    for (; built < n; ++built)
+                        construct(std::addressof(b->data[idx + built].value));
+                }
+                catch (...)
+                {
+                    Skipfield::append(std::to_address(b->skip), idx, built);
+                    b->used += built;
+                    b->sz += built;
+                    _sz += built;
+                    // Blocks are never left empty
+                    if (b->sz == 0)
+                        retire_block(b);
+                    throw;
+                }
+
+                Skipfield::append(std::to_address(b->skip), idx, n);
+                b->used += n;
+                b->sz += n;
+                _sz += n;
+                count -= n;
+            }
+        }
+
+        // Partitioning
+        /**********************************************************************/
+        template<typename Range>
+        range_vector<Range> partition_as(size_type parts)
+        {
+            using range_iterator = std::ranges::iterator_t<Range>;
+
+            range_vector<Range> ranges{typename range_vector<Range>::allocator_type{_alloc}};
+            if (_sz == 0 || parts == 0)
+                return ranges;
+            parts = std::min(parts, _sz);
+
+            // Range k ends after the block that brings the running count to at least boundary(k)
+            const auto boundary = [this, parts](size_type k) { return _sz / parts * (k + 1) + std::min(k + 1, _sz % parts); };
+
+            auto first = _blocks;
+            size_type before = 0, count = 0, k = 0;
+            for (auto b = _blocks; b != nullptr; b = b->next)
+            {
+                count += b->sz;
+                if (count < boundary(k) && b->next != nullptr)
+                    continue;
+
+                const auto last = b->next != nullptr ? range_iterator{b->next, b->next->first()} : range_iterator{b, b->used};
+                ranges.emplace_back(range_iterator{first, first->first()}, last, count - before);
+                while (k < parts - 1 && boundary(k) <= count)
+                    ++k;
+                first = b->next;
+                before = count;
+            }
+            return ranges;
+        }
+
+        template<typename Ranges, typename F>
+        void run_on_threads(const Ranges& ranges, F& f) const
+        {
+            // Below this many elements per thread, starting the threads costs more than it saves
+            constexpr size_type MIN_THREAD_ELEMENTS = 1 << 12;
+
+            const auto count = ranges.size();
+            if (count <= 1 || _sz < 2 * MIN_THREAD_ELEMENTS)
+            {
+                for (size_type i = 0; i < count; ++i)
+                    f(ranges[i], i);
+                return;
+            }
+
+            const auto errors = std::make_unique<std::exception_ptr[]>(count);
+            const auto run = [&](size_type i)
+            {
+                try
+                {
+                    f(ranges[i], i);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            };
+
+            {
+                const auto workers = std::make_unique<std::jthread[]>(count - 1);
+                for (size_type i = 1; i < count; ++i)
+                    workers[i - 1] = std::jthread(run, i);
+                run(0);
+            } // Joins the workers
+
+            for (size_type i = 0; i < count; ++i)
+                if (errors[i] != nullptr)
+                    std::rethrow_exception(errors[i]);
+        }
+        /**********************************************************************/
+
+        // Compaction
+        /**********************************************************************/
+        /*
+         * Blocks are ranked by how full they are. The sparsest is emptied into the free slots of
+         * the densest if all of its elements fit in the blocks ranked above it, then the next
+         * sparsest, and so on. Emptied blocks go to the pool.
+         */
+        void compact()
+        {
+            using block_ptr_allocator_type = typename alloc_traits::template rebind_alloc<block*>;
+            vector<block*, block_ptr_allocator_type> order{block_ptr_allocator_type{_alloc}};
+            size_type free_slots = 0;
+            for (auto b = _blocks; b != nullptr; b = b->next)
+            {
+                order.push_back(b);
+                free_slots += b->cap - b->sz;
+            }
+            std::sort(order.begin(), order.end(), [](const block* a, const block* b) { return a->sz * b->cap > b->sz * a->cap; });
+
+            // free_slots counts those left in the blocks ranked above the donor
+            size_type receiver = 0;
+            for (auto d = order.size(); d-- > 1; )
+            {
+                const auto donor = order[d];
+                free_slots -= donor->cap - donor->sz;
+                if (receiver >= d || free_slots < donor->sz)
+                    break;
+                free_slots -= donor->sz;
+
+                for (auto idx = donor->first(); ; )
+                {
+                    while (order[receiver]->sz == order[receiver]->cap)
+                        ++receiver;
+
+                    // Step off before the skipfield changes under the slot
+                    const auto next = Skipfield::next(std::to_address(donor->skip), idx, donor->used);
+                    if (!relocate(donor, idx, order[receiver]))
+                        break;
+                    idx = next;
+                }
+            }
+        }
+
+        // Moves the element in slot idx of from into a free slot of to. Returns whether from still holds any
+        bool relocate(block* from, size_type idx, block* to)
         {
-            if (_blocks_w_space == nullptr)
+            auto& src = from->data[idx].value;
+            const bool hole = to->free_head != NO_INDEX;
+            const size_type dest = hole ? to->free_head : to->used;
+            if (hole)
+                take_free(to, dest);
+
+            try
             {
-                // No free block
-                auto new_block = block_alloc_traits::allocate(_block_alloc, 1);
-                block_alloc_traits::construct(_block_alloc, new_block, _alloc, _skipfield_alloc, _nx_block_sz)
+                alloc_traits::construct(_alloc, std::addressof(to->data[dest].value), std::move_if_noexcept(src));
+            }
+            catch (...)
+            {
+                if (hole)
+                    make_free(to, dest);
+                throw;
+            }
 
-                if (_blocks == nullptr)
-                    _blocks = new_block; // 1st allocated block
+            if (!hole)
+            {
+                Skipfield::append(std::to_address(to->skip), dest);
+                ++to->used;
+            }
+            ++to->sz;
 
-                _nx_block_sz *= GROWTH_FACTOR; // TODO: Bound to limits
+            alloc_traits::destroy(_alloc, std::addressof(src));
+            if (--from->sz == 0)
+            {
+                retire_block(from);
+                return false;
             }
+            make_free(from, idx);
+            return true;
+        }
+        /**********************************************************************/
+
+        // Free lists
+        /**********************************************************************/
+        static free_links& links(block* b, size_type idx) noexcept { return b->data[idx].links; }
+
+        void link_w_space(block* b) noexcept
+        {
+            b->prev_w_space = nullptr;
+            b->next_w_space = _blocks_w_space;
+            if (_blocks_w_space != nullptr)
+                _blocks_w_space->prev_w_space = b;
+            _blocks_w_space = b;
+        }
+
+        void unlink_w_space(block* b) noexcept
+        {
+            (b->prev_w_space != nullptr ? b->prev_w_space->next_w_space : _blocks_w_space) = b->next_w_space;
+            if (b->next_w_space != nullptr)
+                b->next_w_space->prev_w_space = b->prev_w_space;
+            b->prev_w_space = b->next_w_space = nullptr;
+        }
+
+        void push_free(block* b, size_type idx) noexcept
+        {
+            const auto head = b->free_head;
+            std::construct_at(&links(b, idx), free_links{NO_INDEX, head});
+            if (head != NO_INDEX)
+                links(b, head).prev = static_cast<index_type>(idx);
+            else
+                link_w_space(b);
+            b->free_head = static_cast<index_type>(idx);
         }
+
+        void unlink_free(block* b, size_type idx) noexcept
+        {
+            const auto [prev, next] = links(b, idx);
+            (prev != NO_INDEX ? links(b, prev).next : b->free_head) = next;
+            if (next != NO_INDEX)
+                links(b, next).prev = prev;
+
+            if (b->free_head == NO_INDEX)
+                unlink_w_space(b);
+        }
+
+        // Puts the erased slot idx on its block's free list, joining it with neighbouring runs
+        void make_free(block* b, size_type idx) noexcept
+        {
+            const auto merge = Skipfield::erase(std::to_address(b->skip), idx);
+
+            // A run to the right now starts at idx; a run to the left is already listed by its start
+            if (merge.right)
+                unlink_free(b, idx + 1);
+            if (!merge.left)
+                push_free(b, idx);
+        }
+
+        // Takes the first n slots of the listed run starting at idx off the free list so elements can go there
+        void take_free(block* b, size_type idx, size_type n = 1) noexcept
+        {
+            const auto rest = Skipfield::revive(std::to_address(b->skip), idx, n);
+            if (rest == HIVE_NO_SLOT)
+            {
+                unlink_free(b, idx);
+                return;
+            }
+
+            // The rest of the run keeps idx's place in the list
+            const auto [prev, next] = links(b, idx);
+            std::construct_at(&links(b, rest), free_links{prev, next});
+            (prev != NO_INDEX ? links(b, prev).next : b->free_head) = static_cast<index_type>(rest);
+            if (next != NO_INDEX)
+                links(b, next).prev = static_cast<index_type>(rest);
+        }
+        /**********************************************************************/
     };
+
+    template<typename T, typename Allocator, typename Skipfield, typename F>
+    void for_each(execution::sequenced_policy, hive<T, Allocator, Skipfield>& h, F f)
+    {
+        for (auto& elem : h)
+            f(elem);
+    }
+
+    // Calls f on every element, with the hive split across threads. f must be safe to call concurrently
+    template<typename T, typename Allocator, typename Skipfield, typename F>
+    void for_each(execution::parallel_policy policy, hive<T, Allocator, Skipfield>& h, F f)
+    {
+        h.for_each_range(policy, [&f](const auto& range, std::size_t)
+        {
+            for (auto& elem : range)
+                f(elem);
+        });
+    }
+
+    template<typename T, typename Allocator, typename Skipfield, typename U, typename Reduce, typename Transform>
+    U transform_reduce(execution::sequenced_policy, const hive<T, Allocator, Skipfield>& h, U init, Reduce reduce, Transform transform)
+    {
+        for (const auto& elem : h)
+            init = reduce(std::move(init), transform(elem));
+        return init;
+    }
+
+    /*
+     * Reduces each thread's range on its own, then folds the partial results into init in
+     * range order. As with std::transform_reduce, reduce must be associative and commutative
+     * for the result not to depend on how the hive was split.
+     */
+    template<typename T, typename Allocator, typename Skipfield, typename U, typename Reduce, typename Transform>
+    U transform_reduce(execution::parallel_policy policy, const hive<T, Allocator, Skipfield>& h, U init, Reduce reduce, Transform transform)
+    {
+        // One per range, of which there are at most as many as threads. Ranges are never empty,
+        // so each partial result starts from its first element
+        vector<std::optional<U>> partials(policy.thread_count());
+        h.for_each_range(policy, [&](const auto& range, std::size_t i)
+        {
+            auto it = range.begin();
+            U acc = transform(*it);
+            for (++it; it != range.end(); ++it)
+                acc = reduce(std::move(acc), transform(*it));
+            partials[i].emplace(std::move(acc));
+        });
+
+        for (auto& partial : partials)
+            if (partial)
+                init = reduce(std::move(init), std::move(*partial));
+        return init;
+    }
 }
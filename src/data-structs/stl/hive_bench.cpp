@@ -0,0 +1,410 @@
+#include <deque>
+#include <list>
+#include "hive.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Churn benchmark of mystl::hive against std::list, std::deque and mystl::vector.
+ *
+ * Each run fills a container, then repeatedly erases a share of its elements (picked
+ * pseudo-randomly) and inserts as many new ones, the way a pool of game entities lives.
+ * mystl::vector erases with erase_unordered and std::deque the same way by hand (move the
+ * back into the hole), since both would otherwise shift half of their elements per erase.
+ *
+ * Reported per container, element size and erase ratio:
+ *     churn_ns_per_op   time per erase or insert
+ *     iterate_ns_per_elem  one pass summing every element, after the churn
+ *     cache_misses_per_elem  hardware cache misses during that pass, from perf_event_open;
+ *                       -1 where the counter isn't available (not Linux, or not permitted)
+ *     bytes_per_elem    bytes held from the allocator per live element, after the churn
+ *
+ * Usage: hive_bench [csv|json]   (defaults to csv)
+ */
+
+// Allocation tracking
+/******************************************************************************/
+struct alloc_stats
+{
+    std::uint64_t live_bytes = 0;
+};
+
+inline alloc_stats g_alloc_stats;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t count)
+    {
+        g_alloc_stats.live_bytes += count * sizeof(T);
+        if (auto p = std::malloc(count * sizeof(T)))
+            return static_cast<T*>(p);
+        throw std::bad_alloc{};
+    }
+
+    void deallocate(T* p, std::size_t count) noexcept
+    {
+        g_alloc_stats.live_bytes -= count * sizeof(T);
+        std::free(p);
+    }
+
+    friend bool operator==(const counting_allocator&, const counting_allocator&) noexcept { return true; }
+};
+/******************************************************************************/
+
+// Cache miss counter
+/******************************************************************************/
+// Counts hardware cache misses of this thread between start() and stop(), if the kernel lets us
+class cache_miss_counter
+{
+public:
+    cache_miss_counter()
+    {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~cache_miss_counter()
+    {
+#if defined(__linux__)
+        if (_fd != -1)
+            close(_fd);
+#endif
+    }
+
+    cache_miss_counter(const cache_miss_counter&) = delete;
+    cache_miss_counter& operator=(const cache_miss_counter&) = delete;
+
+    bool available() const noexcept { return _fd != -1; }
+
+    void start() noexcept
+    {
+#if defined(__linux__)
+        if (_fd != -1)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    std::uint64_t stop() noexcept
+    {
+        std::uint64_t count = 0;
+#if defined(__linux__)
+        if (_fd != -1)
+        {
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_fd, &count, sizeof(count)) != sizeof(count))
+                count = 0;
+        }
+#endif
+        return count;
+    }
+
+private:
+    int _fd = -1;
+};
+/******************************************************************************/
+
+// Element types
+/******************************************************************************/
+template<std::size_t Bytes>
+struct padded
+{
+    std::uint64_t words[Bytes / sizeof(std::uint64_t)];
+};
+
+template<typename T>
+T make(std::uint64_t i)
+{
+    T value{};
+    value.words[0] = i;
+    return value;
+}
+
+// Stops the compiler from optimising away work whose result is never read
+template<typename T>
+void do_not_optimize(T& value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Cheap, reproducible stream of pseudo-random numbers (xorshift64)
+struct rng
+{
+    std::uint64_t state = 0x9e3779b97f4a7c15;
+
+    std::uint64_t operator()() noexcept
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+/******************************************************************************/
+
+// Containers
+/******************************************************************************/
+/*
+ * Each adapter gives a container the same two operations: insert, and erase_if, which erases
+ * each element the predicate picks in one pass. The timed iteration goes over c directly.
+ */
+template<typename T>
+struct hive_adapter
+{
+    using value_type = T;
+    static constexpr std::string_view name = "mystl::hive";
+    mystl::hive<T, counting_allocator<T>> c;
+
+    void insert(const T& value) { c.insert(value); }
+
+    template<typename Pred>
+    void erase_if(Pred pred)
+    {
+        for (auto it = c.begin(); it != c.end(); )
+            it = pred() ? c.erase(it) : std::next(it);
+    }
+};
+
+template<typename T>
+struct list_adapter
+{
+    using value_type = T;
+    static constexpr std::string_view name = "std::list";
+    std::list<T, counting_allocator<T>> c;
+
+    void insert(const T& value) { c.push_back(value); }
+
+    template<typename Pred>
+    void erase_if(Pred pred)
+    {
+        for (auto it = c.begin(); it != c.end(); )
+            it = pred() ? c.erase(it) : std::next(it);
+    }
+};
+
+// Unordered erase for containers that only erase cheaply at the back
+template<typename Container, typename Pred>
+void erase_if_unordered(Container& c, Pred pred)
+{
+    for (std::size_t i = 0; i < c.size(); )
+    {
+        if (!pred())
+        {
+            ++i;
+            continue;
+        }
+        if (i != c.size() - 1)
+            c[i] = std::move(c.back());
+        c.pop_back();
+    }
+}
+
+template<typename T>
+struct deque_adapter
+{
+    using value_type = T;
+    static constexpr std::string_view name = "std::deque";
+    std::deque<T, counting_allocator<T>> c;
+
+    void insert(const T& value) { c.push_back(value); }
+
+    template<typename Pred>
+    void erase_if(Pred pred) { erase_if_unordered(c, pred); }
+};
+
+template<typename T>
+struct vector_adapter
+{
+    using value_type = T;
+    static constexpr std::string_view name = "mystl::vector";
+    mystl::vector<T, counting_allocator<T>> c;
+
+    void insert(const T& value) { c.push_back(value); }
+
+    template<typename Pred>
+    void erase_if(Pred pred)
+    {
+        for (auto it = c.begin(); it != c.end(); )
+            it = pred() ? c.erase_unordered(it) : std::next(it);
+    }
+};
+/******************************************************************************/
+
+// Workload
+/******************************************************************************/
+constexpr std::size_t ELEMENT_COUNT = 1 << 16;
+constexpr int CHURN_ROUNDS = 8;
+constexpr int REPETITIONS = 7;
+
+struct result
+{
+    std::string_view container;
+    std::size_t element_bytes;
+    double erase_ratio;
+    double churn_ns_per_op;
+    double iterate_ns_per_elem;
+    double cache_misses_per_elem;
+    double bytes_per_elem;
+};
+
+/*
+ * Fills an adapter, churns it CHURN_ROUNDS times at the given erase ratio, then times a summing
+ * pass over it. Repeated REPETITIONS times on a fresh container, keeping the fastest times.
+ */
+template<typename Adapter>
+result run_churn(double erase_ratio, cache_miss_counter& misses)
+{
+    using T = typename Adapter::value_type;
+    using namespace std::chrono;
+
+    auto best_churn = std::numeric_limits<double>::infinity(); // ns per op, fractional so fast ops don't round to whole ns
+    auto best_iterate = nanoseconds::max();
+    std::uint64_t best_misses = 0;
+    double bytes_per_elem = 0;
+    const auto threshold = static_cast<std::uint64_t>(erase_ratio * static_cast<double>(UINT64_MAX));
+
+    for (int rep = 0; rep < REPETITIONS; ++rep)
+    {
+        const auto bytes_before = g_alloc_stats.live_bytes;
+        Adapter a;
+        rng random;
+        std::uint64_t next_value = 0;
+        for (std::size_t i = 0; i < ELEMENT_COUNT; ++i)
+            a.insert(make<T>(next_value++));
+
+        std::size_t ops = 0;
+        const auto churn_start = steady_clock::now();
+        for (int round = 0; round < CHURN_ROUNDS; ++round)
+        {
+            const auto before = a.c.size();
+            a.erase_if([&] { return random() < threshold; });
+            const auto erased = before - a.c.size();
+            for (std::size_t i = 0; i < erased; ++i)
+                a.insert(make<T>(next_value++));
+            ops += 2 * erased;
+        }
+        const auto churn_time = steady_clock::now() - churn_start;
+
+        std::uint64_t sum = 0;
+        misses.start();
+        const auto iterate_start = steady_clock::now();
+        for (const auto& elem : a.c)
+            sum += elem.words[0];
+        const auto iterate_time = steady_clock::now() - iterate_start;
+        const auto iterate_misses = misses.stop();
+        do_not_optimize(sum);
+
+        if (ops != 0)
+            best_churn = std::min(best_churn, duration<double, std::nano>(churn_time).count() / static_cast<double>(ops));
+        if (iterate_time < best_iterate)
+        {
+            best_iterate = duration_cast<nanoseconds>(iterate_time);
+            best_misses = iterate_misses;
+        }
+        bytes_per_elem = static_cast<double>(g_alloc_stats.live_bytes - bytes_before) / static_cast<double>(a.c.size());
+    }
+
+    return {Adapter::name, sizeof(T), erase_ratio,
+        best_churn == std::numeric_limits<double>::infinity() ? 0.0 : best_churn,
+        static_cast<double>(best_iterate.count()) / ELEMENT_COUNT,
+        misses.available() ? static_cast<double>(best_misses) / ELEMENT_COUNT : -1.0,
+        bytes_per_elem};
+}
+
+template<typename T>
+void run_element(std::vector<result>& out, cache_miss_counter& misses)
+{
+    for (const double ratio : {0.1, 0.5, 0.9})
+    {
+        out.push_back(run_churn<hive_adapter<T>>(ratio, misses));
+        out.push_back(run_churn<list_adapter<T>>(ratio, misses));
+        out.push_back(run_churn<deque_adapter<T>>(ratio, misses));
+        out.push_back(run_churn<vector_adapter<T>>(ratio, misses));
+    }
+}
+/******************************************************************************/
+
+// Output
+/******************************************************************************/
+void print_csv(const std::vector<result>& results)
+{
+    std::cout << "container,element_bytes,erase_ratio,churn_ns_per_op,iterate_ns_per_elem,cache_misses_per_elem,bytes_per_elem\n";
+    for (const auto& r : results)
+    {
+        std::cout << r.container << ',' << r.element_bytes << ',' << r.erase_ratio << ',' << r.churn_ns_per_op << ','
+            << r.iterate_ns_per_elem << ',' << r.cache_misses_per_elem << ',' << r.bytes_per_elem << '\n';
+    }
+}
+
+void print_json(const std::vector<result>& results)
+{
+    std::cout << "[\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& r = results[i];
+        std::cout << "  {\"container\": \"" << r.container << "\", \"element_bytes\": " << r.element_bytes
+            << ", \"erase_ratio\": " << r.erase_ratio << ", \"churn_ns_per_op\": " << r.churn_ns_per_op
+            << ", \"iterate_ns_per_elem\": " << r.iterate_ns_per_elem << ", \"cache_misses_per_elem\": " << r.cache_misses_per_elem
+            << ", \"bytes_per_elem\": " << r.bytes_per_elem
+            << (i + 1 < results.size() ? "},\n" : "}\n");
+    }
+    std::cout << "]\n";
+}
+/******************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    const std::string_view format = argc > 1 ? argv[1] : "csv";
+    if (format != "csv" && format != "json")
+    {
+        std::cerr << "usage: " << argv[0] << " [csv|json]\n";
+        return 1;
+    }
+
+    cache_miss_counter misses;
+    if (!misses.available())
+        std::cerr << "perf_event_open unavailable, cache misses are reported as -1\n";
+
+    std::vector<result> results;
+    run_element<padded<8>>(results, misses);
+    run_element<padded<64>>(results, misses);
+    run_element<padded<256>>(results, misses);
+
+    if (format == "json")
+        print_json(results);
+    else
+        print_csv(results);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if !defined(__linux__)
+#error "mmap_allocator relies on mremap, which is Linux-only"
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace mystl
+{
+    /*
+     * Allocator for very large arrays that maps memory straight from the kernel.
+     *
+     * Mappings are made with MAP_NORESERVE, so pages are only committed once they are
+     * touched. On top of the usual interface it provides reallocate(), which resizes a
+     * mapping with mremap. The kernel moves page table entries instead of copying the data,
+     * so growing never needs the old and new buffers to exist side by side. vector uses
+     * reallocate() for trivially relocatable elements; other types are still moved over one
+     * by one into a fresh mapping.
+     *
+     * With HugePages, mappings are 2MiB aligned and advised with MADV_HUGEPAGE so that
+     * transparent huge pages can back them (subject to the system's THP setting). A mapping
+     * that reallocate() has to move is moved onto a fresh 2MiB boundary too.
+     */
+    template<typename T, bool HugePages = false>
+    class mmap_allocator
+    {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind { using other = mmap_allocator<U, HugePages>; };
+
+        mmap_allocator() noexcept = default;
+
+        template<typename U>
+        mmap_allocator(const mmap_allocator<U, HugePages>&) noexcept {}
+
+        T* allocate(std::size_t count)
+        {
+            if (count == 0)
+                return nullptr;
+
+            const auto bytes = mapping_size(count);
+            const auto p = map(bytes, PROT_READ | PROT_WRITE);
+
+            if constexpr (HugePages)
+                ::madvise(p, bytes, MADV_HUGEPAGE);
+
+            return reinterpret_cast<T*>(p);
+        }
+
+        void deallocate(T* p, std::size_t count) noexcept
+        {
+            if (p != nullptr)
+                ::munmap(p, mapping_size(count));
+        }
+
+        // Resizes a mapping from allocate(), possibly moving it. Contents are kept byte for byte
+        T* reallocate(T* p, std::size_t old_count, std::size_t new_count)
+        {
+            if (p == nullptr)
+                return allocate(new_count);
+
+            if (new_count == 0)
+            {
+                deallocate(p, old_count);
+                return nullptr;
+            }
+
+            const auto old_bytes = mapping_size(old_count);
+            const auto new_bytes = mapping_size(new_count);
+            if (old_bytes == new_bytes)
+                return p;
+
+            if constexpr (HugePages)
+            {
+                // Left to itself mremap may move the mapping to any page boundary. So resize it in
+                // place if there's room, and otherwise move it onto a range reserved at a huge page boundary
+                auto new_p = ::mremap(p, old_bytes, new_bytes, 0);
+                if (new_p == MAP_FAILED)
+                {
+                    const auto target = map(new_bytes, PROT_NONE);
+                    new_p = ::mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+                    if (new_p == MAP_FAILED)
+                    {
+                        ::munmap(target, new_bytes);
+                        throw std::bad_alloc{};
+                    }
+                }
+
+                ::madvise(new_p, new_bytes, MADV_HUGEPAGE);
+                return static_cast<T*>(new_p);
+            }
+
+            const auto new_p = ::mremap(p, old_bytes, new_bytes, MREMAP_MAYMOVE);
+            if (new_p == MAP_FAILED)
+                throw std::bad_alloc{};
+
+            return static_cast<T*>(new_p);
+        }
+
+        friend bool operator==(const mmap_allocator&, const mmap_allocator&) noexcept { return true; }
+
+    private:
+        static constexpr std::size_t HUGE_PAGE_SIZE = 2 << 20;
+
+        // Maps bytes (a multiple of the page size) of fresh memory, starting on a huge page boundary with HugePages
+        static std::byte* map(std::size_t bytes, int prot)
+        {
+            const auto map_bytes = HugePages ? bytes + HUGE_PAGE_SIZE : bytes;
+
+            auto p = static_cast<std::byte*>(::mmap(nullptr, map_bytes, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+            if (p == MAP_FAILED)
+                throw std::bad_alloc{};
+
+            if constexpr (HugePages)
+            {
+                // Trim the over-mapped slack so the mapping starts on a huge page boundary
+                const auto addr = reinterpret_cast<std::uintptr_t>(p);
+                const auto head = (HUGE_PAGE_SIZE - addr % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+                if (head != 0)
+                    ::munmap(p, head);
+                ::munmap(p + head + bytes, map_bytes - head - bytes);
+                p += head;
+            }
+
+            return p;
+        }
+
+        static std::size_t mapping_size(std::size_t count)
+        {
+            if (count > SIZE_MAX / sizeof(T) - HUGE_PAGE_SIZE)
+                throw std::bad_array_new_length{};
+
+            static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const auto granularity = HugePages ? HUGE_PAGE_SIZE : page_size;
+            return (count * sizeof(T) + granularity - 1) / granularity * granularity;
+        }
+    };
+}
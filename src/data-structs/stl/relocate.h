@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace mystl
+{
+    // Types that can be moved to new storage by copying their bytes and forgetting the
+    // original. Trivially copyable types always qualify; specialise this for other types
+    // (e.g. ones holding only a unique_ptr) to let containers grow them with memcpy/realloc.
+    template<typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+    template<typename T>
+    inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+    /*
+     * Element-level building blocks shared by the contiguous containers (vector, small_vector).
+     * They work on a raw [data, data + size) range and the allocator that owns it; allocating,
+     * freeing and updating the container's own members is left to the caller.
+     */
+    namespace detail
+    {
+        // Whether the allocator does anything beyond placement new when constructing elements
+        template<typename T, typename Allocator>
+        inline constexpr bool allocator_constructs = requires(Allocator& a, T* p, T&& v) { a.construct(p, std::move(v)); };
+
+        // Elements that may be relocated with a plain memcpy
+        template<typename T, typename Allocator>
+        inline constexpr bool memcpy_relocatable = is_trivially_relocatable_v<T> && !allocator_constructs<T, Allocator>;
+
+        // Whether elements can be shifted in place without a move throwing halfway through
+        template<typename T, typename Allocator>
+        inline constexpr bool nothrow_shift =
+            memcpy_relocatable<T, Allocator> || (std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>);
+
+        template<typename Allocator, typename Pointer>
+        constexpr void destroy_n(Allocator& alloc, Pointer first, std::size_t count) noexcept
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                std::allocator_traits<Allocator>::destroy(alloc, first + i);
+        }
+
+        template<typename Allocator, typename Pointer, typename T>
+        constexpr void construct_n(Allocator& alloc, Pointer dest, std::size_t count, const T& value)
+        {
+            std::size_t i = 0;
+            try
+            {
+                for (; i < count; ++i)
+                    std::allocator_traits<Allocator>::construct(alloc, dest + i, value);
+            }
+            catch (...)
+            {
+                destroy_n(alloc, dest, i);
+                throw;
+            }
+        }
+
+        /*
+         * Builds count elements at dest from the ones at first, leaving the originals alone.
+         *
+         * gcc's implementation copies elements during expansion instead of moving them,
+         * because a throwing move would leave the container unable to return to its state
+         * before the expansion. So elements are only moved when their move constructor
+         * can't throw, and copied otherwise (std::move_if_noexcept), in which case the
+         * source is still intact if an exception escapes.
+         */
+        template<typename Allocator, typename Pointer>
+        constexpr void transfer_n(Allocator& alloc, Pointer first, std::size_t count, Pointer dest)
+        {
+            std::size_t i = 0;
+            try
+            {
+                for (; i < count; ++i)
+                    std::allocator_traits<Allocator>::construct(alloc, dest + i, std::move_if_noexcept(first[i]));
+            }
+            catch (...)
+            {
+                destroy_n(alloc, dest, i);
+                throw;
+            }
+        }
+
+        // Moves count elements into uninitialised memory at dest and destroys the originals
+        template<typename Allocator, typename Pointer>
+        constexpr void relocate(Allocator& alloc, Pointer first, std::size_t count, Pointer dest)
+        {
+            using T = typename std::allocator_traits<Allocator>::value_type;
+
+            if constexpr (memcpy_relocatable<T, Allocator>)
+            {
+                if !consteval
+                {
+                    if (count != 0)
+                        std::memcpy(std::to_address(dest), std::to_address(first), count * sizeof(T));
+                    return;
+                }
+            }
+
+            transfer_n(alloc, first, count, dest);
+            destroy_n(alloc, first, count);
+        }
+
+        // Relocates [data, data + size) into new_data, leaving out [index, index + count). If this throws, the elements are untouched
+        template<typename Allocator, typename Pointer>
+        constexpr void relocate_around(Allocator& alloc, Pointer data, std::size_t size, Pointer new_data, std::size_t index, std::size_t count)
+        {
+            using T = typename std::allocator_traits<Allocator>::value_type;
+
+            if constexpr (memcpy_relocatable<T, Allocator>)
+            {
+                if !consteval
+                {
+                    relocate(alloc, data, index, new_data);
+                    relocate(alloc, data + index, size - index, new_data + index + count);
+                    return;
+                }
+            }
+
+            // Both halves are built before any original is destroyed
+            transfer_n(alloc, data, index, new_data);
+            try
+            {
+                transfer_n(alloc, data + index, size - index, new_data + index + count);
+            }
+            catch (...)
+            {
+                destroy_n(alloc, new_data, index);
+                throw;
+            }
+            destroy_n(alloc, data, size);
+        }
+
+        // Shifts [index, size) right by count, leaving [index, index + count) uninitialised. Only exception safe for nothrow_shift
+        template<typename Allocator, typename Pointer>
+        constexpr void open_gap(Allocator& alloc, Pointer data, std::size_t size, std::size_t index, std::size_t count)
+        {
+            using T = typename std::allocator_traits<Allocator>::value_type;
+
+            if constexpr (memcpy_relocatable<T, Allocator>)
+            {
+                if !consteval
+                {
+                    std::memmove(std::to_address(data + index + count), std::to_address(data + index), (size - index) * sizeof(T));
+                    return;
+                }
+            }
+
+            const auto tail = size - index;
+            const auto last = data + size;
+            if (tail > count)
+            {
+                // The last count elements move into uninitialised memory, the rest shift in place
+                for (std::size_t i = 0; i < count; ++i)
+                    std::allocator_traits<Allocator>::construct(alloc, last + i, std::move(*(last - count + i)));
+                std::move_backward(data + index, last - count, last);
+                destroy_n(alloc, data + index, count);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < tail; ++i)
+                    std::allocator_traits<Allocator>::construct(alloc, data + index + count + i, std::move(data[index + i]));
+                destroy_n(alloc, data + index, tail);
+            }
+        }
+
+        // Undoes open_gap, shifting [index + count, size + count) back down to index
+        template<typename Allocator, typename Pointer>
+        constexpr void close_gap(Allocator& alloc, Pointer data, std::size_t size, std::size_t index, std::size_t count) noexcept
+        {
+            using T = typename std::allocator_traits<Allocator>::value_type;
+
+            if constexpr (memcpy_relocatable<T, Allocator>)
+            {
+                if !consteval
+                {
+                    std::memmove(std::to_address(data + index), std::to_address(data + index + count), (size - index) * sizeof(T));
+                    return;
+                }
+            }
+
+            const auto tail = size - index;
+            for (std::size_t i = 0; i < tail; ++i)
+            {
+                auto& from = data[index + count + i];
+                if (i < count)
+                    std::allocator_traits<Allocator>::construct(alloc, data + index + i, std::move(from));
+                else
+                    data[index + i] = std::move(from);
+            }
+            const auto first_dead = index + std::max(count, tail);
+            destroy_n(alloc, data + first_dead, index + count + tail - first_dead);
+        }
+
+        /*
+         * Fills new_data with [data, data + size) and count new elements at index, built by
+         * construct(dest). The new elements are built first, straight into place, and the old
+         * ones are then relocated around them, so each existing element is moved only once.
+         * If anything throws, data is left as it was and new_data holds no elements.
+         */
+        template<typename Allocator, typename Pointer, typename Construct>
+        constexpr void build_around(Allocator& alloc, Pointer data, std::size_t size, Pointer new_data, std::size_t index, std::size_t count, Construct&& construct)
+        {
+            construct(new_data + index);
+            try
+            {
+                relocate_around(alloc, data, size, new_data, index, count);
+            }
+            catch (...)
+            {
+                destroy_n(alloc, new_data + index, count);
+                throw;
+            }
+        }
+
+        // Makes room for count elements at index within the existing capacity and has construct(dest) build them there
+        template<typename Allocator, typename Pointer, typename Construct>
+        constexpr void insert_in_place(Allocator& alloc, Pointer data, std::size_t size, std::size_t index, std::size_t count, Construct&& construct)
+        {
+            open_gap(alloc, data, size, index, count);
+            try
+            {
+                construct(data + index);
+            }
+            catch (...)
+            {
+                close_gap(alloc, data, size, index, count);
+                throw;
+            }
+        }
+    }
+}
@@ -0,0 +1,571 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <format>
+#include <type_traits>
+
+#include "relocate.h"
+
+namespace mystl
+{
+    /*
+     * A vector that stores up to N elements in an inline buffer and only allocates from
+     * Allocator once it outgrows it. Unlike vector, this is not usable in constant
+     * expressions since elements may live inside the object's own byte buffer.
+     *
+     * Moving a small_vector whose elements are inline moves the elements one by one, and
+     * swapping two of them is no longer O(1) for the same reason.
+     */
+    template<
+        typename T,
+        std::size_t N,
+        typename Allocator = std::allocator<T>
+    > class small_vector
+    {
+    private:
+        using alloc_traits = std::allocator_traits<Allocator>;
+
+        static_assert(N > 0, "small_vector: use vector when no inline storage is wanted");
+        static_assert(std::is_same_v<typename alloc_traits::pointer, T*>, "small_vector: fancy pointers are not supported");
+
+    public:
+        using value_type = T;
+        using allocator_type = Allocator;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using pointer = alloc_traits::pointer;
+        using const_pointer = alloc_traits::const_pointer;
+        using iterator = pointer;
+        using const_iterator = const_pointer;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        static constexpr size_type inline_capacity = N;
+
+        // Constructors
+        /**********************************************************************/
+        small_vector() noexcept(noexcept(Allocator())) : small_vector(Allocator()) {}
+
+        explicit small_vector(const Allocator& alloc) noexcept :
+            _alloc{alloc}, _sz{0}, _cap{N}, _data{inline_data()}
+        {}
+
+        explicit small_vector(size_type count, const Allocator& alloc = Allocator()) :
+            small_vector(alloc)
+        {
+            reserve(count);
+            for (; _sz < count; ++_sz)
+                alloc_traits::construct(_alloc, _data + _sz);
+        }
+
+        small_vector(size_type count, const T& value, const Allocator& alloc = Allocator()) :
+            small_vector(alloc)
+        {
+            reserve(count);
+            for (; _sz < count; ++_sz)
+                alloc_traits::construct(_alloc, _data + _sz, value);
+        }
+
+        template<std::input_iterator InputIt>
+        small_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator()) :
+            small_vector(alloc)
+        {
+            if constexpr (std::forward_iterator<InputIt>)
+                reserve(static_cast<size_type>(std::distance(first, last)));
+
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        small_vector(const small_vector& other) :
+            small_vector(alloc_traits::select_on_container_copy_construction(other.get_allocator()))
+        {
+            reserve(other._sz);
+            for (; _sz < other._sz; ++_sz)
+                alloc_traits::construct(_alloc, _data + _sz, other._data[_sz]);
+        }
+
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) :
+            small_vector(std::move(other._alloc))
+        {
+            steal_from(other);
+        }
+
+        small_vector(std::initializer_list<T> init, const Allocator& alloc = Allocator()) :
+            small_vector(init.begin(), init.end(), alloc)
+        {}
+        /**********************************************************************/
+
+        ~small_vector()
+        {
+            clear();
+            release_heap();
+        }
+
+        // Assignments
+        /**********************************************************************/
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this == &other)
+                return *this;
+
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value)
+            {
+                if (_alloc != other._alloc)
+                {
+                    // Memory from the current allocator can't be kept after it is replaced
+                    clear();
+                    release_heap();
+                }
+                _alloc = other._alloc;
+            }
+
+            assign(other.begin(), other.end());
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other)
+            noexcept(std::is_nothrow_move_constructible_v<T>
+                && (alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value))
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+
+            if constexpr (alloc_traits::propagate_on_container_move_assignment::value)
+            {
+                release_heap();
+                _alloc = std::move(other._alloc);
+                steal_from(other);
+            }
+            else if (_alloc == other._alloc || other.is_inline())
+            {
+                if (!other.is_inline())
+                    release_heap();
+                steal_from(other);
+            }
+            else
+            {
+                // Not allowed to take other's memory. Move elements individually
+                reserve(other._sz);
+                for (; _sz < other._sz; ++_sz)
+                    alloc_traits::construct(_alloc, _data + _sz, std::move(other._data[_sz]));
+                other.clear();
+            }
+
+            return *this;
+        }
+
+        small_vector& operator=(std::initializer_list<T> ilist)
+        {
+            assign(ilist.begin(), ilist.end());
+            return *this;
+        }
+
+        void assign(size_type count, const T& value)
+        {
+            const T copy(value); // value may be one of our elements
+            clear();
+            reserve(count);
+            for (; _sz < count; ++_sz)
+                alloc_traits::construct(_alloc, _data + _sz, copy);
+        }
+
+        template<std::input_iterator InputIt>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            if constexpr (std::forward_iterator<InputIt>)
+                reserve(static_cast<size_type>(std::distance(first, last)));
+
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        void assign(std::initializer_list<T> ilist) { assign(ilist.begin(), ilist.end()); }
+        /**********************************************************************/
+
+        // Element access
+        /**********************************************************************/
+        reference operator[](size_type pos) { return _data[pos]; }
+        const_reference operator[](size_type pos) const { return _data[pos]; }
+
+        reference at(size_type pos)
+        {
+            check_bounds(pos);
+            return (*this)[pos];
+        }
+        const_reference at(size_type pos) const
+        {
+            check_bounds(pos);
+            return (*this)[pos];
+        }
+
+        reference front() { return _data[0]; }
+        const_reference front() const { return _data[0]; }
+        reference back() { return _data[_sz - 1]; }
+        const_reference back() const { return _data[_sz - 1]; }
+        pointer data() noexcept { return _data; }
+        const_pointer data() const noexcept { return _data; }
+        /**********************************************************************/
+
+        // Iterators
+        /**********************************************************************/
+        iterator begin() noexcept { return _data; }
+        const_iterator begin() const noexcept { return _data; }
+        const_iterator cbegin() const noexcept { return _data; }
+        iterator end() noexcept { return _data + _sz; }
+        const_iterator end() const noexcept { return _data + _sz; }
+        const_iterator cend() const noexcept { return _data + _sz; }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+        /**********************************************************************/
+
+        // Modifiers
+        /**********************************************************************/
+        void clear() noexcept
+        {
+            for (size_type i = 0; i < _sz; ++i)
+                alloc_traits::destroy(_alloc, _data + i);
+            _sz = 0;
+        }
+
+        template<typename TVal>
+        void push_back(TVal&& value)
+        {
+            emplace_back(std::forward<TVal>(value));
+        }
+        template<typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            // Build into the new buffer when growing, so that args referring to our own elements stay valid
+            if (_sz == _cap)
+                return *insert_realloc(_sz, 1, [&](pointer dest) { alloc_traits::construct(_alloc, dest, std::forward<Args>(args)...); });
+
+            alloc_traits::construct(_alloc, _data + _sz, std::forward<Args>(args)...);
+            return _data[_sz++];
+        }
+
+        template<typename TVal>
+        iterator insert(const_iterator pos, TVal&& value)
+        {
+            return emplace(pos, std::forward<TVal>(value));
+        }
+        iterator insert(const_iterator pos, size_type count, const T& value)
+        {
+            const auto index = static_cast<size_type>(pos - cbegin());
+            if (count == 0)
+                return _data + index;
+
+            if (_sz + count <= _cap && contains(std::addressof(value)))
+            {
+                // Shifting the elements would move value from under us
+                const T copy(value);
+                return insert_with(index, count, [&](pointer dest) { detail::construct_n(_alloc, dest, count, copy); });
+            }
+
+            return insert_with(index, count, [&](pointer dest) { detail::construct_n(_alloc, dest, count, value); });
+        }
+        template<std::input_iterator InputIt>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        {
+            const auto index = static_cast<size_type>(pos - cbegin());
+
+            if constexpr (std::forward_iterator<InputIt>)
+            {
+                const auto count = static_cast<size_type>(std::distance(first, last));
+                return insert_with(index, count, [&](pointer dest)
+                {
+                    size_type i = 0;
+                    try
+                    {
+                        for (; first != last; ++first, ++i)
+                            alloc_traits::construct(_alloc, dest + i, *first);
+                    }
+                    catch (...)
+                    {
+                        detail::destroy_n(_alloc, dest, i);
+                        throw;
+                    }
+                });
+            }
+            else
+            {
+                // Length is unknown up front. Append, then rotate into place
+                const auto old_sz = _sz;
+                for (; first != last; ++first)
+                    emplace_back(*first);
+                std::rotate(_data + index, _data + old_sz, _data + _sz);
+                return _data + index;
+            }
+        }
+        iterator insert(const_iterator pos, std::initializer_list<T> ilist)
+        {
+            return insert(pos, ilist.begin(), ilist.end());
+        }
+
+        template<typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args)
+        {
+            const auto index = static_cast<size_type>(pos - cbegin());
+
+            if (_sz < _cap && index != _sz)
+            {
+                // Build the element first, args may refer to elements about to be shifted
+                T new_elem(std::forward<Args>(args)...);
+                return insert_with(index, 1, [&](pointer dest) { alloc_traits::construct(_alloc, dest, std::move(new_elem)); });
+            }
+
+            return insert_with(index, 1, [&](pointer dest) { alloc_traits::construct(_alloc, dest, std::forward<Args>(args)...); });
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            const auto index = static_cast<size_type>(first - cbegin());
+            const auto cnt = static_cast<size_type>(last - first);
+            if (cnt == 0)
+                return _data + index;
+
+            if constexpr (memcpy_relocatable)
+            {
+                detail::destroy_n(_alloc, _data + index, cnt);
+                std::memmove(_data + index, _data + index + cnt, (_sz - index - cnt) * sizeof(T));
+            }
+            else
+            {
+                std::move(_data + index + cnt, _data + _sz, _data + index);
+                detail::destroy_n(_alloc, _data + _sz - cnt, cnt);
+            }
+
+            _sz -= cnt;
+            return _data + index;
+        }
+
+        void pop_back()
+        {
+            if (!empty())
+                alloc_traits::destroy(_alloc, _data + --_sz);
+        }
+
+        void resize(size_type count) { resize_impl(count); }
+        void resize(size_type count, const value_type& value)
+        {
+            if (count > _cap && contains(std::addressof(value)))
+            {
+                // Growing frees the buffer value lives in before the new elements are built
+                const T copy(value);
+                resize_impl(count, copy);
+                return;
+            }
+
+            resize_impl(count, value);
+        }
+        /**********************************************************************/
+
+        // Capacity
+        /**********************************************************************/
+        bool empty() const noexcept { return _sz == 0; }
+        size_type size() const noexcept { return _sz; }
+        size_type capacity() const noexcept { return _cap; }
+        bool is_inline() const noexcept { return _data == inline_data(); }
+
+        void reserve(size_type new_cap)
+        {
+            if (new_cap <= _cap)
+                return;
+
+            move_to(alloc_traits::allocate(_alloc, new_cap), new_cap);
+        }
+
+        // Moves the elements back inline if they fit, otherwise reallocates to the exact size
+        void shrink_to_fit()
+        {
+            if (is_inline() || _sz == _cap)
+                return;
+
+            if (_sz <= N)
+                move_to(inline_data(), N);
+            else
+                move_to(alloc_traits::allocate(_alloc, _sz), _sz);
+        }
+        /**********************************************************************/
+
+        allocator_type get_allocator() const noexcept { return _alloc; }
+
+        void swap(small_vector& other)
+            noexcept(std::is_nothrow_move_constructible_v<T>
+                && (alloc_traits::propagate_on_container_swap::value || alloc_traits::is_always_equal::value))
+        {
+            if (!is_inline() && !other.is_inline())
+            {
+                if constexpr (alloc_traits::propagate_on_container_swap::value)
+                    std::swap(_alloc, other._alloc);
+
+                std::swap(_sz, other._sz);
+                std::swap(_cap, other._cap);
+                std::swap(_data, other._data);
+                return;
+            }
+
+            // Inline elements have to be moved across individually
+            small_vector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        bool operator==(const small_vector& other) const
+        {
+            if (this == &other)
+                return true;
+            if (_sz != other._sz)
+                return false;
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+        auto operator<=>(const small_vector& other) const
+        {
+            return std::lexicographical_compare_three_way(begin(), end(), other.begin(), other.end());
+        }
+
+    private:
+        static constexpr bool memcpy_relocatable = detail::memcpy_relocatable<T, Allocator>;
+        static constexpr bool nothrow_shift = detail::nothrow_shift<T, Allocator>;
+
+        allocator_type _alloc;
+        size_type _sz, _cap;
+        pointer _data;
+        alignas(T) std::byte _buf[N * sizeof(T)];
+
+        pointer inline_data() noexcept { return reinterpret_cast<pointer>(_buf); }
+        const_pointer inline_data() const noexcept { return reinterpret_cast<const_pointer>(_buf); }
+
+        bool contains(const T* p) const noexcept
+        {
+            return std::less_equal<>{}(_data, p) && std::less<>{}(p, _data + _sz);
+        }
+
+        void check_bounds(size_type pos) const
+        {
+            if (pos >= _sz)
+                throw std::out_of_range{std::format("small_vector: index {} out of range of size {}", pos, _sz)};
+        }
+
+        void release_heap() noexcept
+        {
+            if (!is_inline())
+                alloc_traits::deallocate(_alloc, _data, _cap);
+            _data = inline_data();
+            _cap = N;
+        }
+
+        // Takes other's elements, leaving it empty and inline. Allocators must be interchangeable
+        void steal_from(small_vector& other)
+        {
+            if (other.is_inline())
+            {
+                detail::relocate(_alloc, other._data, other._sz, _data);
+            }
+            else
+            {
+                _data = other._data;
+                _cap = other._cap;
+                other._data = other.inline_data();
+                other._cap = N;
+            }
+
+            _sz = other._sz;
+            other._sz = 0;
+        }
+
+        // Relocates the elements into new_data (either the inline buffer or fresh heap memory)
+        void move_to(pointer new_data, size_type new_cap)
+        {
+            try
+            {
+                detail::relocate(_alloc, _data, _sz, new_data);
+            }
+            catch (...)
+            {
+                if (new_data != inline_data())
+                    alloc_traits::deallocate(_alloc, new_data, new_cap);
+                throw;
+            }
+
+            release_heap();
+            _data = new_data;
+            _cap = new_cap;
+        }
+
+        /*
+         * Moves to a new buffer (grown if count more elements don't fit) with count elements at
+         * index, having construct(dest) build them there before the existing elements are moved
+         * around them. If anything throws, the small_vector is left as it was.
+         */
+        template<typename Construct>
+        iterator insert_realloc(size_type index, size_type count, Construct&& construct)
+        {
+            const auto new_cap = _sz + count > _cap ? std::max(_sz + count, _cap * 2) : _cap;
+            const auto new_data = alloc_traits::allocate(_alloc, new_cap);
+            try
+            {
+                detail::build_around(_alloc, _data, _sz, new_data, index, count, std::forward<Construct>(construct));
+            }
+            catch (...)
+            {
+                alloc_traits::deallocate(_alloc, new_data, new_cap);
+                throw;
+            }
+
+            release_heap();
+            _data = new_data;
+            _cap = new_cap;
+            _sz += count;
+            return _data + index;
+        }
+
+        // Makes room for count elements at index and has construct(dest) build them there
+        template<typename Construct>
+        iterator insert_with(size_type index, size_type count, Construct&& construct)
+        {
+            // A shift whose moves may throw can't be undone halfway, so those go through a new buffer
+            if (_sz + count > _cap || (index != _sz && !nothrow_shift))
+                return insert_realloc(index, count, std::forward<Construct>(construct));
+
+            detail::insert_in_place(_alloc, _data, _sz, index, count, std::forward<Construct>(construct));
+            _sz += count;
+            return _data + index;
+        }
+
+        template<typename... Args>
+        void resize_impl(size_type count, Args&&... args)
+        {
+            if (count <= _sz)
+            {
+                detail::destroy_n(_alloc, _data + count, _sz - count);
+                _sz = count;
+                return;
+            }
+
+            if (count > _cap)
+                reserve(std::max(count, _cap * 2));
+
+            for (; _sz < count; ++_sz)
+                alloc_traits::construct(_alloc, _data + _sz, std::forward<Args>(args)...);
+        }
+    };
+}
@@ -0,0 +1,579 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <iterator>
+#include <algorithm>
+#include <format>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+#include "vector.h"
+
+namespace mystl
+{
+    /*
+     * A row of a soa_vector: a tuple of references to its fields. It is a type of its own so
+     * that it can declare a common reference with the row's value type, which std::tuple<Ts&...>
+     * only gets from C++23's tuple changes; without one the row iterators aren't
+     * std::random_access_iterators.
+     */
+    template<typename... Refs>
+    struct soa_reference : std::tuple<Refs...>
+    {
+        using std::tuple<Refs...>::tuple;
+        using std::tuple<Refs...>::operator=;
+
+        // Swaps the rows referred to, so algorithms like std::sort can permute a soa_vector
+        friend void swap(soa_reference a, soa_reference b) requires (!std::is_const_v<std::remove_reference_t<Refs>> && ...)
+        {
+            static_cast<std::tuple<Refs...>&>(a).swap(b);
+        }
+    };
+
+    /*
+     * Structure-of-arrays vector: each field of a row lives in its own contiguous array, so a
+     * loop over a few fields only pulls those fields into cache. All arrays share a single
+     * allocation, and each one starts on a field_alignment (cache line) boundary so that
+     * loops over field<I>() can use aligned SIMD loads.
+     *
+     * Rows are accessed through soa_reference proxies, tuples of references to the fields, e.g.
+     *     auto [x, y] = v[i];
+     *     for (auto [x, y] : v) ...
+     *
+     * Capacity grows through the same policies as vector.
+     */
+    template<typename GrowthPolicy, typename... Ts>
+    class basic_soa_vector
+    {
+        static_assert(sizeof...(Ts) > 0, "soa_vector: needs at least one field");
+
+    public:
+        using value_type = std::tuple<Ts...>;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = soa_reference<Ts&...>;
+        using const_reference = soa_reference<const Ts&...>;
+
+        template<size_type I>
+        using field_type = std::tuple_element_t<I, value_type>;
+
+        static constexpr size_type field_count = sizeof...(Ts);
+        static constexpr size_type field_alignment = std::max({std::size_t{64}, alignof(Ts)...});
+
+        template<bool Const>
+        class row_iterator
+        {
+        private:
+            using owner_type = std::conditional_t<Const, const basic_soa_vector, basic_soa_vector>;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = basic_soa_vector::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<Const, basic_soa_vector::const_reference, basic_soa_vector::reference>;
+            using pointer = void;
+
+            row_iterator() noexcept = default;
+            row_iterator(owner_type* owner, size_type pos) noexcept : _owner{owner}, _pos{pos} {}
+
+            // Allow iterator -> const_iterator
+            template<bool OtherConst>
+                requires (Const && !OtherConst)
+            row_iterator(const row_iterator<OtherConst>& other) noexcept :
+                _owner{other._owner}, _pos{other._pos}
+            {}
+
+            reference operator*() const { return (*_owner)[_pos]; }
+            reference operator[](difference_type n) const { return (*_owner)[_pos + n]; }
+
+            row_iterator& operator++() noexcept { ++_pos; return *this; }
+            row_iterator operator++(int) noexcept { auto tmp = *this; ++_pos; return tmp; }
+            row_iterator& operator--() noexcept { --_pos; return *this; }
+            row_iterator operator--(int) noexcept { auto tmp = *this; --_pos; return tmp; }
+            row_iterator& operator+=(difference_type n) noexcept { _pos += n; return *this; }
+            row_iterator& operator-=(difference_type n) noexcept { _pos -= n; return *this; }
+
+            friend row_iterator operator+(row_iterator it, difference_type n) noexcept { return it += n; }
+            friend row_iterator operator+(difference_type n, row_iterator it) noexcept { return it += n; }
+            friend row_iterator operator-(row_iterator it, difference_type n) noexcept { return it -= n; }
+            friend difference_type operator-(const row_iterator& a, const row_iterator& b) noexcept
+            {
+                return static_cast<difference_type>(a._pos) - static_cast<difference_type>(b._pos);
+            }
+
+            friend bool operator==(const row_iterator& a, const row_iterator& b) noexcept { return a._pos == b._pos; }
+            friend auto operator<=>(const row_iterator& a, const row_iterator& b) noexcept { return a._pos <=> b._pos; }
+
+            size_type index() const noexcept { return _pos; }
+
+        private:
+            friend class row_iterator<!Const>;
+
+            owner_type* _owner = nullptr;
+            size_type _pos = 0;
+        };
+
+        using iterator = row_iterator<false>;
+        using const_iterator = row_iterator<true>;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        // Constructors
+        /**********************************************************************/
+        basic_soa_vector() noexcept = default;
+
+        explicit basic_soa_vector(size_type count) { resize(count); }
+
+        basic_soa_vector(const basic_soa_vector& other)
+        {
+            reserve(other._sz);
+            try
+            {
+                for (; _sz < other._sz; ++_sz)
+                    construct_row(_store, _sz, other[_sz]);
+            }
+            catch (...)
+            {
+                // The destructor doesn't run for a constructor that throws
+                clear();
+                deallocate(_store);
+                throw;
+            }
+        }
+
+        basic_soa_vector(basic_soa_vector&& other) noexcept :
+            _store{std::exchange(other._store, storage{})},
+            _sz{std::exchange(other._sz, 0)}
+        {}
+        /**********************************************************************/
+
+        ~basic_soa_vector()
+        {
+            clear();
+            deallocate(_store);
+        }
+
+        // Assignments
+        /**********************************************************************/
+        basic_soa_vector& operator=(const basic_soa_vector& other)
+        {
+            if (this != &other)
+            {
+                basic_soa_vector copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        basic_soa_vector& operator=(basic_soa_vector&& other) noexcept
+        {
+            if (this != &other)
+            {
+                basic_soa_vector moved(std::move(other));
+                swap(moved);
+            }
+            return *this;
+        }
+        /**********************************************************************/
+
+        // Element access
+        /**********************************************************************/
+        reference operator[](size_type pos) { return row(pos, std::index_sequence_for<Ts...>{}); }
+        const_reference operator[](size_type pos) const { return row(pos, std::index_sequence_for<Ts...>{}); }
+
+        reference at(size_type pos)
+        {
+            check_bounds(pos);
+            return (*this)[pos];
+        }
+        const_reference at(size_type pos) const
+        {
+            check_bounds(pos);
+            return (*this)[pos];
+        }
+
+        reference front() { return (*this)[0]; }
+        const_reference front() const { return (*this)[0]; }
+        reference back() { return (*this)[_sz - 1]; }
+        const_reference back() const { return (*this)[_sz - 1]; }
+
+        // Contiguous view over one field of every row
+        template<size_type I>
+        std::span<field_type<I>> field() noexcept { return {std::get<I>(_store.fields), _sz}; }
+        template<size_type I>
+        std::span<const field_type<I>> field() const noexcept { return {std::get<I>(_store.fields), _sz}; }
+
+        template<size_type I>
+        field_type<I>* data() noexcept { return std::get<I>(_store.fields); }
+        template<size_type I>
+        const field_type<I>* data() const noexcept { return std::get<I>(_store.fields); }
+        /**********************************************************************/
+
+        // Iterators
+        /**********************************************************************/
+        iterator begin() noexcept { return {this, 0}; }
+        const_iterator begin() const noexcept { return {this, 0}; }
+        const_iterator cbegin() const noexcept { return {this, 0}; }
+        iterator end() noexcept { return {this, _sz}; }
+        const_iterator end() const noexcept { return {this, _sz}; }
+        const_iterator cend() const noexcept { return {this, _sz}; }
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+        const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(cend()); }
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+        const_reverse_iterator crend() const noexcept { return const_reverse_iterator(cbegin()); }
+        /**********************************************************************/
+
+        // Modifiers
+        /**********************************************************************/
+        void clear() noexcept
+        {
+            destroy_rows(0, _sz);
+            _sz = 0;
+        }
+
+        void push_back(const Ts&... values) { emplace_back(values...); }
+        void push_back(Ts&&... values) { emplace_back(std::move(values)...); }
+
+        // Constructs each field of the new row from the matching argument
+        template<typename... Args>
+            requires (sizeof...(Args) == sizeof...(Ts))
+        reference emplace_back(Args&&... args)
+        {
+            auto field_args = std::forward_as_tuple(std::forward<Args>(args)...);
+
+            if (_sz == _store.cap)
+            {
+                // Build the row in the new storage first, args may refer to our own rows
+                auto new_store = allocate(GrowthPolicy::next_capacity(_store.cap, _sz + 1, ROW_SIZE));
+                try
+                {
+                    construct_row(new_store, _sz, std::move(field_args));
+                }
+                catch (...)
+                {
+                    deallocate(new_store);
+                    throw;
+                }
+
+                try
+                {
+                    relocate_to(new_store);
+                }
+                catch (...)
+                {
+                    destroy_rows(new_store, _sz, 1);
+                    deallocate(new_store);
+                    throw;
+                }
+            }
+            else
+            {
+                construct_row(_store, _sz, std::move(field_args));
+            }
+
+            return (*this)[_sz++];
+        }
+
+        void pop_back()
+        {
+            if (!empty())
+                destroy_rows(--_sz, 1);
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            const auto index = pos.index();
+            erase_fields(index, std::index_sequence_for<Ts...>{});
+            destroy_rows(--_sz, 1);
+            return {this, index};
+        }
+
+        // Erases pos by moving the last row into its place. O(1), but doesn't keep the order
+        iterator erase_unordered(const_iterator pos)
+        {
+            const auto index = pos.index();
+            if (index != _sz - 1)
+                (*this)[index] = std::move(row_values(_sz - 1));
+            destroy_rows(--_sz, 1);
+            return {this, index};
+        }
+
+        void resize(size_type count)
+        {
+            if (count <= _sz)
+            {
+                destroy_rows(count, _sz - count);
+                _sz = count;
+                return;
+            }
+
+            if (count > _store.cap)
+                reserve(GrowthPolicy::next_capacity(_store.cap, count, ROW_SIZE));
+
+            for (; _sz < count; ++_sz)
+                construct_row(_store, _sz, std::tuple<>{});
+        }
+
+        void swap(basic_soa_vector& other) noexcept
+        {
+            std::swap(_store, other._store);
+            std::swap(_sz, other._sz);
+        }
+        /**********************************************************************/
+
+        // Capacity
+        /**********************************************************************/
+        bool empty() const noexcept { return _sz == 0; }
+        size_type size() const noexcept { return _sz; }
+        size_type capacity() const noexcept { return _store.cap; }
+
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > _store.cap)
+                reallocate(new_cap);
+        }
+
+        void shrink_to_fit()
+        {
+            if (_sz == _store.cap)
+                return;
+
+            if (_sz == 0)
+            {
+                deallocate(_store);
+                _store = storage{};
+                return;
+            }
+
+            reallocate(_sz);
+        }
+        /**********************************************************************/
+
+        bool operator==(const basic_soa_vector& other) const
+        {
+            if (_sz != other._sz)
+                return false;
+            for (size_type i = 0; i < _sz; ++i)
+                if ((*this)[i] != other[i])
+                    return false;
+            return true;
+        }
+
+    private:
+        static constexpr size_type ROW_SIZE = (sizeof(Ts) + ...);
+
+        struct storage
+        {
+            void* block = nullptr;
+            std::tuple<Ts*...> fields{};
+            size_type cap = 0;
+        };
+
+        storage _store;
+        size_type _sz = 0;
+
+        template<std::size_t... Is>
+        reference row(size_type pos, std::index_sequence<Is...>) { return {std::get<Is>(_store.fields)[pos]...}; }
+        template<std::size_t... Is>
+        const_reference row(size_type pos, std::index_sequence<Is...>) const { return {std::get<Is>(_store.fields)[pos]...}; }
+
+        // Row as a tuple of rvalue references, for moving a whole row at once
+        std::tuple<Ts&&...> row_values(size_type pos)
+        {
+            return std::apply([pos](auto*... fields) { return std::tuple<Ts&&...>{std::move(fields[pos])...}; }, _store.fields);
+        }
+
+        void check_bounds(size_type pos) const
+        {
+            if (pos >= _sz)
+                throw std::out_of_range{std::format("soa_vector: index {} out of range of size {}", pos, _sz)};
+        }
+
+        static size_type align_up(size_type n) { return (n + field_alignment - 1) / field_alignment * field_alignment; }
+
+        // One block holding every field's array back to back, each starting on an aligned boundary
+        static storage allocate(size_type cap)
+        {
+            if (cap > std::numeric_limits<size_type>::max() / ROW_SIZE / 2)
+                throw std::bad_array_new_length{};
+
+            storage s;
+            s.cap = cap;
+
+            size_type offsets[] = {sizeof(Ts)...};
+            size_type bytes = 0;
+            for (auto& offset : offsets)
+            {
+                const auto field_bytes = align_up(offset * cap);
+                offset = bytes;
+                bytes += field_bytes;
+            }
+
+            s.block = ::operator new(bytes, std::align_val_t{field_alignment});
+            const auto base = static_cast<std::byte*>(s.block);
+            [&]<std::size_t... Is>(std::index_sequence<Is...>)
+            {
+                s.fields = {reinterpret_cast<Ts*>(base + offsets[Is])...};
+            }(std::index_sequence_for<Ts...>{});
+
+            return s;
+        }
+
+        static void deallocate(const storage& s) noexcept
+        {
+            if (s.block != nullptr)
+                ::operator delete(s.block, std::align_val_t{field_alignment});
+        }
+
+        static void destroy_rows(const storage& s, size_type first, size_type count) noexcept
+        {
+            std::apply([=](auto*... fields) { (std::destroy_n(fields + first, count), ...); }, s.fields);
+        }
+
+        void destroy_rows(size_type first, size_type count) noexcept { destroy_rows(_store, first, count); }
+
+        // Constructs field I onwards of row index from args (value-initialising fields that have no argument)
+        template<size_type I = 0, typename Tuple>
+        static void construct_row(storage& s, size_type index, Tuple&& args)
+        {
+            if constexpr (I < sizeof...(Ts))
+            {
+                const auto dest = std::get<I>(s.fields) + index;
+                if constexpr (I < std::tuple_size_v<std::remove_cvref_t<Tuple>>)
+                    std::construct_at(dest, std::get<I>(std::forward<Tuple>(args)));
+                else
+                    std::construct_at(dest);
+
+                try
+                {
+                    construct_row<I + 1>(s, index, std::forward<Tuple>(args));
+                }
+                catch (...)
+                {
+                    std::destroy_at(dest);
+                    throw;
+                }
+            }
+        }
+
+        /*
+         * Moves (or copies, if moving may throw) count elements to uninitialised dest, leaving the
+         * originals for release_field. Trivially relocatable fields are copied byte for byte, so
+         * until then only one of the two copies owns anything.
+         */
+        template<typename T>
+        static void transfer_field(T* first, size_type count, T* dest)
+        {
+            if constexpr (is_trivially_relocatable_v<T>)
+            {
+                if (count != 0)
+                    std::memcpy(dest, first, count * sizeof(T));
+            }
+            else
+            {
+                size_type i = 0;
+                try
+                {
+                    for (; i < count; ++i)
+                        std::construct_at(dest + i, std::move_if_noexcept(first[i]));
+                }
+                catch (...)
+                {
+                    std::destroy_n(dest, i);
+                    throw;
+                }
+            }
+        }
+
+        // Ends the lifetime of count elements that transfer_field has copied elsewhere. For
+        // the transferred originals once the move is done, or the copies if it is abandoned
+        template<typename T>
+        static void release_field(T* first, size_type count) noexcept
+        {
+            if constexpr (!is_trivially_relocatable_v<T>)
+                std::destroy_n(first, count);
+        }
+
+        // Transfers fields I onwards of every row to new_store. If one throws, those already transferred are released again
+        template<size_type I = 0>
+        void transfer_fields(storage& new_store)
+        {
+            if constexpr (I < sizeof...(Ts))
+            {
+                transfer_field(std::get<I>(_store.fields), _sz, std::get<I>(new_store.fields));
+                try
+                {
+                    transfer_fields<I + 1>(new_store);
+                }
+                catch (...)
+                {
+                    release_field(std::get<I>(new_store.fields), _sz);
+                    throw;
+                }
+            }
+        }
+
+        // Moves the rows into new_store and frees the old storage. If this throws, the rows are untouched and new_store is left to the caller
+        void relocate_to(storage new_store)
+        {
+            // Every field is moved before any original is destroyed, so a throw can still be undone
+            transfer_fields(new_store);
+            std::apply([this](auto*... fields) { (release_field(fields, _sz), ...); }, _store.fields);
+
+            deallocate(_store);
+            _store = new_store;
+        }
+
+        void reallocate(size_type new_cap)
+        {
+            auto new_store = allocate(new_cap);
+            try
+            {
+                relocate_to(new_store);
+            }
+            catch (...)
+            {
+                deallocate(new_store);
+                throw;
+            }
+        }
+
+        template<std::size_t... Is>
+        void erase_fields(size_type index, std::index_sequence<Is...>)
+        {
+            ((void)std::move(std::get<Is>(_store.fields) + index + 1, std::get<Is>(_store.fields) + _sz, std::get<Is>(_store.fields) + index), ...);
+        }
+    };
+
+    template<typename... Ts>
+    using soa_vector = basic_soa_vector<doubling_growth, Ts...>;
+}
+
+// Lets structured bindings take rows apart like the tuples they are
+template<typename... Refs>
+struct std::tuple_size<mystl::soa_reference<Refs...>> : std::tuple_size<std::tuple<Refs...>> {};
+
+template<std::size_t I, typename... Refs>
+struct std::tuple_element<I, mystl::soa_reference<Refs...>> : std::tuple_element<I, std::tuple<Refs...>> {};
+
+// A row and a row's value meet at the value, the way vector<bool>'s bit reference and bool do
+template<typename... Refs, typename... Us, template<typename> class RQual, template<typename> class UQual>
+    requires (sizeof...(Refs) == sizeof...(Us))
+struct std::basic_common_reference<mystl::soa_reference<Refs...>, std::tuple<Us...>, RQual, UQual>
+{
+    using type = std::tuple<Us...>;
+};
+
+template<typename... Us, typename... Refs, template<typename> class UQual, template<typename> class RQual>
+    requires (sizeof...(Refs) == sizeof...(Us))
+struct std::basic_common_reference<std::tuple<Us...>, mystl::soa_reference<Refs...>, UQual, RQual>
+{
+    using type = std::tuple<Us...>;
+};
@@ -0,0 +1,755 @@
+#include "concurrent_hive.h"
+#include "concurrent_vector.h"
+#include "hive.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "vector.h"
+
+#if defined(__linux__)
+#include "mmap_allocator.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+/*
+ * Checks for the containers that main.cpp doesn't exercise: growth, insert and erase, and what
+ * is left behind when an element's copy or move throws halfway through one of them. Built with
+ * the address and undefined behaviour sanitizers (make run-tests), so an element destroyed twice
+ * or never destroyed fails the run even where the checks themselves pass.
+ */
+
+// Checking
+/******************************************************************************/
+#define CHECK(cond) check((cond), #cond, __FILE__, __LINE__)
+
+void check(bool ok, const char* expr, const char* file, int line)
+{
+    if (ok)
+        return;
+
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    std::exit(1);
+}
+
+// Runs f, which should throw E
+template<typename E = std::runtime_error, typename F>
+void check_throws(F f, const char* file, int line)
+{
+    try
+    {
+        f();
+    }
+    catch (const E&)
+    {
+        return;
+    }
+    check(false, "expected an exception", file, line);
+}
+
+#define CHECK_THROWS(...) check_throws([&] { __VA_ARGS__; }, __FILE__, __LINE__)
+/******************************************************************************/
+
+// Element types
+/******************************************************************************/
+/*
+ * Holds its value on the heap, so destroying one twice is a double free and never destroying
+ * one is a leak. Once copies_left copies (or moves) have been made, the next one throws. Its
+ * move constructor may throw, so containers copy it when relocating (move_if_noexcept).
+ */
+struct thrower
+{
+    static inline int copies_left = -1; // -1: never throw
+    static inline std::atomic<int> live = 0; // The concurrent containers construct them from several threads
+
+    int* value;
+
+    explicit thrower(int v = 0) : value{new int(v)} { ++live; }
+
+    thrower(const thrower& other) : value{new int(*other.value)}
+    {
+        maybe_throw();
+        ++live;
+    }
+
+    thrower(thrower&& other) noexcept(false) : value{new int(*other.value)}
+    {
+        maybe_throw();
+        ++live;
+    }
+
+    thrower& operator=(const thrower& other)
+    {
+        if (copies_left == 0)
+            throw std::runtime_error{"thrower: copy assignment"};
+        if (copies_left > 0)
+            --copies_left;
+        *value = *other.value;
+        return *this;
+    }
+
+    thrower& operator=(thrower&& other) noexcept(false) { return *this = other; }
+
+    ~thrower()
+    {
+        delete value;
+        --live;
+    }
+
+    void maybe_throw()
+    {
+        if (copies_left == 0)
+        {
+            delete value;
+            throw std::runtime_error{"thrower: copy"};
+        }
+        if (copies_left > 0)
+            --copies_left;
+    }
+
+    friend bool operator==(const thrower& a, const thrower& b) { return *a.value == *b.value; }
+};
+
+// Fails a later copy of thrower for as long as it is alive
+struct throw_after
+{
+    explicit throw_after(int copies) { thrower::copies_left = copies; }
+    ~throw_after() { thrower::copies_left = -1; }
+};
+
+template<typename Container>
+bool holds(const Container& c, std::initializer_list<int> values)
+{
+    if (c.size() != values.size())
+        return false;
+
+    auto it = c.begin();
+    for (const auto v : values)
+    {
+        if (*it->value != v)
+            return false;
+        ++it;
+    }
+    return true;
+}
+/******************************************************************************/
+
+// vector
+/******************************************************************************/
+void test_vector()
+{
+    {
+        // Growing at the back goes through realloc for trivially copyable elements
+        mystl::vector<int> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i);
+        v.push_back(v[0]); // Refers into the buffer being grown
+        CHECK(v.size() == 1001 && v[999] == 999 && v[1000] == 0);
+
+        v.insert(v.begin() + 1, 3, -1);
+        v.erase(v.begin() + 10, v.begin() + 20);
+        CHECK(v.size() == 994 && v[1] == -1 && v[3] == -1 && v[4] == 1 && v[10] == 17);
+    }
+
+    {
+        mystl::vector<std::string> v{"a", "b", "c"};
+        v.shrink_to_fit();
+        v.resize(10, v[0]);
+        CHECK(v.size() == 10 && v[9] == "a" && v[2] == "c");
+    }
+
+    {
+        mystl::vector<std::string> v;
+        for (int i = 0; i < 100; ++i)
+            v.emplace_back(v.empty() ? "x" : v.back() + "x");
+        CHECK(v.size() == 100 && v[99].size() == 100);
+
+        v.insert(v.begin() + 50, v.begin(), v.begin() + 10);
+        CHECK(v.size() == 110 && v[50] == "x" && v[60].size() == 51);
+    }
+
+    for (int fail_at = 0; fail_at < 8; ++fail_at)
+    {
+        // Growing in the middle: every original element must survive a copy failing
+        mystl::vector<thrower> v;
+        for (int i = 0; i < 4; ++i)
+            v.emplace_back(i);
+        v.shrink_to_fit();
+
+        const throw_after guard{fail_at};
+        try
+        {
+            v.emplace(v.begin() + 2, 9);
+            CHECK(holds(v, {0, 1, 9, 2, 3}));
+        }
+        catch (const std::runtime_error&)
+        {
+            CHECK(holds(v, {0, 1, 2, 3}));
+        }
+    }
+
+    for (int fail_at = 0; fail_at < 8; ++fail_at)
+    {
+        // Inserting in the middle without growing
+        mystl::vector<thrower> v;
+        v.reserve(16);
+        for (int i = 0; i < 4; ++i)
+            v.emplace_back(i);
+
+        const thrower t{7};
+        const throw_after guard{fail_at};
+        try
+        {
+            v.insert(v.begin() + 1, 2, t);
+            CHECK(holds(v, {0, 7, 7, 1, 2, 3}));
+        }
+        catch (const std::runtime_error&)
+        {
+            CHECK(holds(v, {0, 1, 2, 3}));
+        }
+    }
+
+    CHECK(thrower::live == 0);
+}
+/******************************************************************************/
+
+// mmap_allocator
+/******************************************************************************/
+void test_mmap_allocator()
+{
+#if defined(__linux__)
+    {
+        // Grows through mremap, so the elements must come through every move intact
+        mystl::vector<int, mystl::mmap_allocator<int>> v;
+        for (int i = 0; i < 1 << 20; ++i)
+            v.push_back(i);
+        CHECK(v.size() == 1 << 20 && v[0] == 0 && v[12345] == 12345 && v.back() == (1 << 20) - 1);
+
+        v.insert(v.begin() + 1, 2, -1);
+        v.erase(v.begin() + 3, v.begin() + 5);
+        CHECK(v.size() == 1 << 20 && v[1] == -1 && v[2] == -1 && v[3] == 3);
+
+        v.resize(10);
+        v.shrink_to_fit();
+        CHECK(v.size() == 10 && v[9] == 9);
+    }
+
+    {
+        // Huge page mappings have to stay 2MiB aligned wherever mremap puts them
+        mystl::vector<int, mystl::mmap_allocator<int, true>> v;
+        bool aligned = true;
+        for (int i = 0; i < 4 << 20; ++i)
+        {
+            v.push_back(i);
+            aligned = aligned && reinterpret_cast<std::uintptr_t>(v.data()) % (2 << 20) == 0;
+        }
+        CHECK(aligned && v[(4 << 20) - 1] == (4 << 20) - 1);
+    }
+
+    {
+        // Non-trivial elements are moved over one by one instead
+        mystl::vector<std::string, mystl::mmap_allocator<std::string>> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(std::to_string(i));
+        CHECK(v.size() == 1000 && v[999] == "999");
+    }
+#endif
+}
+/******************************************************************************/
+
+// small_vector
+/******************************************************************************/
+void test_small_vector()
+{
+    {
+        mystl::small_vector<std::string, 4> v;
+        for (int i = 0; i < 4; ++i)
+            v.push_back(std::to_string(i));
+        CHECK(v.is_inline());
+
+        v.push_back(v[0]); // Refers to an element of the buffer being replaced
+        CHECK(!v.is_inline() && v.size() == 5 && v[4] == "0");
+
+        v.insert(v.begin() + 1, "x");
+        v.insert(v.begin(), 2, v[3]);
+        CHECK(v.size() == 8 && v[0] == "2" && v[1] == "2" && v[3] == "x");
+
+        v.erase(v.begin(), v.begin() + 3);
+        CHECK(v.size() == 5 && v[0] == "x" && v[4] == "0");
+
+        v.shrink_to_fit();
+        CHECK(v.capacity() == 5);
+        v.resize(2);
+        v.shrink_to_fit();
+        CHECK(v.is_inline() && v[1] == "1");
+    }
+
+    {
+        // The fill value is one of the elements in the buffer being replaced
+        mystl::small_vector<std::string, 2> v{"a", "b", "c"};
+        v.resize(10, v[0]);
+        CHECK(v.size() == 10 && v[9] == "a" && v[2] == "c");
+    }
+
+    for (int fail_at = 0; fail_at < 8; ++fail_at)
+    {
+        // Growing: a copy failing partway must leave the old elements untouched
+        mystl::small_vector<thrower, 2> v;
+        for (int i = 0; i < 4; ++i)
+            v.emplace_back(i);
+
+        {
+            const throw_after guard{fail_at};
+            try
+            {
+                v.emplace(v.begin() + 2, 9);
+                CHECK(holds(v, {0, 1, 9, 2, 3}));
+            }
+            catch (const std::runtime_error&)
+            {
+                CHECK(holds(v, {0, 1, 2, 3}));
+            }
+        }
+
+    }
+
+    for (int fail_at = 0; fail_at < 8; ++fail_at)
+    {
+        // Inserting in the middle without growing, where shifting the elements could throw
+        mystl::small_vector<thrower, 2> v;
+        v.reserve(16);
+        for (int i = 0; i < 4; ++i)
+            v.emplace_back(i);
+
+        const thrower t{7};
+        const throw_after guard{fail_at};
+        try
+        {
+            v.insert(v.begin() + 1, t);
+            CHECK(holds(v, {0, 7, 1, 2, 3}));
+        }
+        catch (const std::runtime_error&)
+        {
+            CHECK(holds(v, {0, 1, 2, 3}));
+        }
+    }
+
+    {
+        mystl::small_vector<thrower, 2> v;
+        v.emplace_back(1);
+        v.emplace_back(2);
+        const throw_after guard{0};
+        CHECK_THROWS(v.emplace_back(3));
+        CHECK(holds(v, {1, 2}) && v.is_inline());
+    }
+
+    CHECK(thrower::live == 0);
+}
+/******************************************************************************/
+
+// soa_vector
+/******************************************************************************/
+using soa = mystl::soa_vector<int, thrower>;
+static_assert(std::random_access_iterator<soa::iterator>);
+static_assert(std::random_access_iterator<soa::const_iterator>);
+
+void test_soa_vector()
+{
+    {
+        mystl::soa_vector<int, std::string> v;
+        for (int i = 0; i < 100; ++i)
+            v.push_back(i, std::to_string(i));
+        v.emplace_back(std::get<0>(v[0]), std::get<1>(v[5])); // Refers into the storage being replaced
+
+        auto [n, s] = v[100];
+        CHECK(v.size() == 101 && n == 0 && s == "5");
+
+        v.erase(v.begin() + 10);
+        v.erase_unordered(v.begin());
+        const auto& cv = v;
+        CHECK(v.size() == 99 && std::get<0>(cv[0]) == 0 && std::get<0>(cv[10]) == 11 && std::get<1>(cv.back()) == "99");
+
+        const auto copy = v;
+        CHECK(copy == v && copy.field<0>()[10] == 11);
+
+        std::sort(v.begin(), v.end(), [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+        CHECK(std::get<0>(v.front()) == 99 && std::get<1>(v.front()) == "99");
+    }
+
+    for (int fail_at = 0; fail_at < 8; ++fail_at)
+    {
+        // A copy failing while growing must leave every row, and every field of it, as it was
+        soa v;
+        for (int i = 0; i < 4; ++i)
+            v.emplace_back(i, thrower{i * 10});
+        v.shrink_to_fit();
+
+        const thrower t{99};
+        const throw_after guard{fail_at};
+        try
+        {
+            v.emplace_back(4, t);
+            CHECK(v.size() == 5 && *std::get<1>(v[4]).value == 99);
+        }
+        catch (const std::runtime_error&)
+        {
+            CHECK(v.size() == 4);
+        }
+        for (int i = 0; i < 4; ++i)
+            CHECK(std::get<0>(v[i]) == i && *std::get<1>(v[i]).value == i * 10);
+    }
+
+    for (int fail_at = 0; fail_at < 4; ++fail_at)
+    {
+        soa v;
+        for (int i = 0; i < 4; ++i)
+            v.emplace_back(i, thrower{i});
+
+        const throw_after guard{fail_at};
+        CHECK_THROWS(soa copy(v));
+    }
+
+    CHECK(thrower::live == 0);
+}
+/******************************************************************************/
+
+// concurrent_vector
+/******************************************************************************/
+void test_concurrent_vector()
+{
+    {
+        constexpr int threads = 4, per_thread = 10000;
+        mystl::concurrent_vector<int> v;
+        {
+            mystl::vector<std::jthread> workers;
+            for (int t = 0; t < threads; ++t)
+                workers.emplace_back([&v, t] { for (int i = 0; i < per_thread; ++i) v.push_back(t * per_thread + i); });
+        }
+
+        // Every value shows up exactly once, wherever its thread's fetch_add put it
+        mystl::vector<char> seen(threads * per_thread);
+        for (const auto x : v)
+            seen[x] = true;
+        CHECK(v.size() == threads * per_thread && std::ranges::all_of(seen, [](char c) { return c != 0; }));
+
+        const auto first = v.grow_by(1000, -1);
+        CHECK(first == threads * per_thread && v.size() == first + 1000 && v.back() == -1);
+
+        v.clear();
+        CHECK(v.empty() && v.capacity() >= first + 1000);
+    }
+
+    for (int fail_at = 0; fail_at < 4; ++fail_at)
+    {
+        // A copy failing partway through grow_by leaves the rest of its run unconstructed
+        mystl::concurrent_vector<thrower> v;
+        v.emplace_back(1);
+
+        const thrower t{7};
+        {
+            const throw_after guard{fail_at};
+            CHECK_THROWS(v.grow_by(4, t));
+        }
+        CHECK(v.size() == 5 && *v[0].value == 1);
+        for (int i = 1; i <= fail_at; ++i)
+            CHECK(*v[i].value == 7);
+
+        v.emplace_back(2);
+        CHECK(*v.back().value == 2);
+
+        if (fail_at % 2 == 0)
+            v.clear(); // Otherwise the destructor has to skip them
+    }
+
+    {
+        // A long run that fails straight away is recorded as one range, not one entry per slot
+        mystl::concurrent_vector<thrower> v;
+        const thrower t{7};
+        {
+            const throw_after guard{0};
+            CHECK_THROWS(v.grow_by(1 << 20, t));
+        }
+        v.emplace_back(1);
+        CHECK(v.size() == (1 << 20) + 1 && *v.back().value == 1);
+        v.clear();
+        v.emplace_back(2);
+        CHECK(v.size() == 1 && *v[0].value == 2);
+    }
+
+    CHECK(thrower::live == 0);
+}
+/******************************************************************************/
+
+// hive
+/******************************************************************************/
+// The values in h, sorted, so layouts that move elements around can be compared
+template<typename Hive>
+mystl::vector<int> sorted_values(const Hive& h)
+{
+    mystl::vector<int> values;
+    for (const auto& x : h)
+        values.push_back(*x.value);
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+bool by_value(const thrower& a, const thrower& b) { return *a.value < *b.value; }
+
+template<typename Skipfield>
+void test_hive_skipfield()
+{
+    using hive = mystl::hive<thrower, std::allocator<thrower>, Skipfield>;
+
+    {
+        hive h;
+        mystl::vector<const thrower*> slots;
+        for (int i = 0; i < 1000; ++i)
+            slots.push_back(std::addressof(*h.emplace(i)));
+        const auto cap = h.capacity();
+
+        // Erased runs of every length from 0 to 9, so iteration has to jump over whole runs
+        mystl::vector<int> kept;
+        for (auto it = h.begin(); it != h.end(); )
+        {
+            const auto v = *it->value;
+            if (v % 10 < v / 10 % 10)
+                it = h.erase(it);
+            else
+            {
+                kept.push_back(v);
+                ++it;
+            }
+        }
+
+        mystl::vector<int> seen;
+        for (const auto& x : h)
+            seen.push_back(*x.value);
+        CHECK(seen == kept && h.size() == kept.size());
+        CHECK(std::distance(h.rbegin(), h.rend()) == static_cast<std::ptrdiff_t>(kept.size()) && *h.rbegin()->value == kept.back());
+
+        // The erased slots are filled again before the hive grows
+        for (auto n = h.size(); n < 1000; ++n)
+            h.emplace(-1);
+        mystl::vector<const thrower*> reused;
+        for (const auto& x : h)
+            reused.push_back(std::addressof(x));
+        std::sort(slots.begin(), slots.end());
+        std::sort(reused.begin(), reused.end());
+        CHECK(h.capacity() == cap && reused == slots);
+    }
+
+    for (const int fail_at : {0, 3, 40, 150})
+    {
+        // A copy failing partway through a bulk insert keeps the elements built before it
+        hive h;
+        for (int i = 0; i < 100; ++i)
+            h.emplace(i);
+        for (auto it = h.begin(); it != h.end(); )
+            it = *it->value % 3 == 0 ? h.erase(it) : std::next(it);
+
+        const thrower t{7};
+        const auto before = h.size();
+        {
+            const throw_after guard{fail_at};
+            CHECK_THROWS(h.insert(200, t));
+        }
+        const auto sevens = std::count_if(h.begin(), h.end(), [](const thrower& x) { return *x.value == 7; });
+        CHECK(h.size() == before + fail_at && sevens == fail_at + 1); // 7 was one of the originals
+        CHECK(std::distance(h.begin(), h.end()) == static_cast<std::ptrdiff_t>(h.size()));
+
+        h.insert(5, t);
+        CHECK(h.size() == before + fail_at + 5);
+    }
+
+    {
+        hive h{mystl::hive_limits{8, 64}};
+        for (int i = 0; i < 500; ++i)
+            h.emplace(i);
+        for (auto it = h.begin(); it != h.end(); )
+            it = *it->value % 4 != 0 ? h.erase(it) : std::next(it);
+        const auto expected = sorted_values(h);
+
+        // Compacting moves the survivors out of the sparse blocks
+        const auto cap = h.capacity();
+        h.shrink_to_fit();
+        CHECK(sorted_values(h) == expected && h.capacity() < cap);
+
+        // Blocks outside the new limits force every element into new ones
+        h.reshape({100, 200});
+        CHECK(sorted_values(h) == expected && h.block_capacity_limits().min == 100);
+
+        // 125 elements to move, a copy failing at any of them leaves the old layout
+        for (int fail_at = 0; fail_at < 120; fail_at += 40)
+        {
+            const throw_after guard{fail_at};
+            CHECK_THROWS(h.reshape({8, 16}));
+            CHECK(sorted_values(h) == expected && h.block_capacity_limits().min == 100);
+        }
+    }
+
+    {
+        hive a, b;
+        for (int i = 0; i < 100; ++i)
+        {
+            a.emplace(99 - i);
+            b.emplace(199 - i);
+        }
+        b.erase(b.begin());
+        const auto kept = std::addressof(*b.begin());
+
+        // Relinks b's blocks, so its elements don't move
+        a.splice(b);
+        CHECK(b.empty() && a.size() == 199 && *kept->value == 198);
+
+        a.sort(by_value);
+        CHECK(std::is_sorted(a.begin(), a.end(), by_value) && *a.begin()->value == 0 && *std::prev(a.end())->value == 198);
+
+        hive narrow{mystl::hive_limits{8, 8}};
+        narrow.emplace(1);
+        check_throws<std::length_error>([&] { narrow.splice(a); }, __FILE__, __LINE__);
+        CHECK(narrow.size() == 1 && a.size() == 199);
+    }
+
+    CHECK(thrower::live == 0);
+}
+
+void test_hive()
+{
+    test_hive_skipfield<mystl::jump_counting_skipfield<UINT8_MAX>>();
+    test_hive_skipfield<mystl::jump_counting_skipfield<UINT16_MAX>>();
+    test_hive_skipfield<mystl::bitmap_skipfield<UINT16_MAX>>();
+
+    // The parallel algorithms and the block views have to see exactly what a serial loop does
+    mystl::hive<int> h;
+    for (int i = 0; i < 1 << 18; ++i)
+        h.insert(i);
+    for (auto it = h.begin(); it != h.end(); )
+        it = *it % 7 == 0 ? h.erase(it) : std::next(it);
+    const auto serial = std::accumulate(h.begin(), h.end(), 0LL);
+
+    const auto parts = h.partition(4);
+    long long part_sum = 0;
+    std::size_t part_sizes = 0;
+    for (const auto& part : parts)
+    {
+        part_sum = std::accumulate(part.begin(), part.end(), part_sum);
+        part_sizes += part.size();
+    }
+    CHECK(!parts.empty() && parts.size() <= 4 && part_sizes == h.size() && part_sum == serial);
+
+    const mystl::execution::parallel_policy par4{4};
+    const auto to_ll = [](int x) { return static_cast<long long>(x); };
+    CHECK(mystl::transform_reduce(par4, h, 0LL, std::plus<>{}, to_ll) == serial);
+    CHECK(mystl::transform_reduce(mystl::execution::seq, h, 0LL, std::plus<>{}, to_ll) == serial);
+
+    mystl::for_each(par4, h, [](int& x) { x *= 2; });
+    CHECK(std::accumulate(h.begin(), h.end(), 0LL) == 2 * serial);
+
+    long long block_sum = 0;
+    std::size_t block_sizes = 0;
+    h.for_each_block([&](auto view)
+    {
+        block_sizes += view.size();
+        if (view.full())
+            block_sum = std::accumulate(view.data().begin(), view.data().end(), block_sum);
+        else
+            view.for_each_run([&](auto run) { block_sum = std::accumulate(run.begin(), run.end(), block_sum); });
+    });
+    CHECK(block_sizes == h.size() && block_sum == 2 * serial);
+
+    // Elements smaller than a slot's free list links are padded out, so there is no plain array to view
+    constexpr auto has_block_views = [](auto& hv) { return requires { hv.for_each_block([](auto) {}); }; };
+    mystl::hive<char> chars{'a', 'b'};
+    static_assert(!has_block_views(chars) && has_block_views(h));
+    chars.erase(chars.begin());
+    CHECK(chars.size() == 1 && *chars.begin() == 'b');
+
+    mystl::hive<int, std::allocator<int>, mystl::bitmap_skipfield<UINT16_MAX>> bits{1, 2, 3, 4, 5};
+    bits.erase(std::next(bits.begin()));
+    std::as_const(bits).for_each_block([](auto view)
+    {
+        std::size_t live = 0;
+        for (const auto word : view.occupancy())
+            live += std::popcount(word);
+        CHECK(live == view.size() && !view.is_live(1) && view.is_live(2));
+    });
+}
+/******************************************************************************/
+
+// concurrent_hive
+/******************************************************************************/
+void test_concurrent_hive()
+{
+    constexpr int threads = 4, per_thread = 5000;
+    mystl::concurrent_hive<thrower> h;
+    mystl::vector<mystl::vector<mystl::concurrent_hive<thrower>::iterator>> inserted(threads);
+    {
+        mystl::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&, t] { for (int i = 0; i < per_thread; ++i) inserted[t].push_back(h.emplace(t * per_thread + i)); });
+    }
+    CHECK(h.size() == threads * per_thread);
+
+    {
+        // Each thread erases the odd elements another thread inserted, sending the slots back to it
+        mystl::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&, t] { for (int i = 1; i < per_thread; i += 2) h.erase(inserted[(t + 1) % threads][i]); });
+    }
+    CHECK(h.size() == threads * per_thread / 2);
+
+    long long sum = 0, expected = 0;
+    for (const auto& x : h)
+        sum += *x.value;
+    for (int i = 0; i < threads * per_thread; i += 2)
+        expected += i;
+    CHECK(sum == expected);
+
+    {
+        // The owners get their erased slots back before allocating new blocks
+        mystl::vector<std::jthread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&] { for (int i = 0; i < per_thread / 2; ++i) h.emplace(-1); });
+    }
+    CHECK(h.size() == threads * per_thread && std::ranges::count_if(h, [](const thrower& x) { return *x.value == -1; }) == threads * per_thread / 2);
+
+    {
+        // A throwing constructor leaves the slot free for the next insert
+        const thrower t{7};
+        h.erase(h.begin());
+        {
+            const throw_after guard{0};
+            CHECK_THROWS(h.insert(t));
+        }
+        CHECK(h.size() == threads * per_thread - 1);
+        CHECK(*h.insert(t)->value == 7 && h.size() == threads * per_thread);
+    }
+
+    h.clear();
+    CHECK(h.empty() && h.begin() == h.end() && thrower::live == 0);
+    h.emplace(3);
+    CHECK(h.size() == 1 && *h.begin()->value == 3);
+}
+/******************************************************************************/
+
+int main()
+{
+    test_vector();
+    test_mmap_allocator();
+    test_small_vector();
+    test_soa_vector();
+    test_concurrent_vector();
+    test_hive();
+    test_concurrent_hive();
+    CHECK(thrower::live == 0);
+    std::puts("all tests passed");
+}
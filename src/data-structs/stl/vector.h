@@ -1,15 +1,79 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
 #include <memory>
+#include <new>
 #include <iterator>
 #include <format>
+#include <span>
+#include <thread>
+#include <type_traits>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "relocate.h"
 
 namespace mystl
 {
+    // Growth policies: next_capacity() picks the capacity to grow to from the current
+    // capacity once `required` elements no longer fit. The result must be >= required.
+    /**************************************************************************/
+    struct doubling_growth
+    {
+        static constexpr std::size_t next_capacity(std::size_t cap, std::size_t required, std::size_t) noexcept
+        {
+            return std::max(required, cap * 2);
+        }
+    };
+
+    // Grows by 1.5x, which wastes less memory than doubling and lets freed blocks be reused
+    struct three_halves_growth
+    {
+        static constexpr std::size_t next_capacity(std::size_t cap, std::size_t required, std::size_t) noexcept
+        {
+            return std::max(required, cap + cap / 2);
+        }
+    };
+
+    // Defers to Base, but rounds buffers of at least Threshold bytes up to whole pages,
+    // so the tail of the last page the allocator hands out isn't wasted
+    template<
+        typename Base = three_halves_growth,
+        std::size_t PageSize = 4096,
+        std::size_t Threshold = 64 * PageSize
+    > struct page_rounded_growth
+    {
+        static constexpr std::size_t next_capacity(std::size_t cap, std::size_t required, std::size_t elem_size) noexcept
+        {
+            const auto new_cap = Base::next_capacity(cap, required, elem_size);
+            const auto bytes = new_cap * elem_size;
+            if (bytes < Threshold)
+                return new_cap;
+
+            return (bytes + PageSize - 1) / PageSize * PageSize / elem_size;
+        }
+    };
+    /**************************************************************************/
+
+    // Tag asking for new elements to be constructed on several threads at once. 0 threads
+    // means std::thread::hardware_concurrency(). Small ranges are still built on the caller's thread
+    struct parallel_construct
+    {
+        unsigned threads = 0;
+    };
+
     template<
         typename T,
-        typename Allocator = std::allocator<T>
+        typename Allocator = std::allocator<T>,
+        typename GrowthPolicy = doubling_growth
     > class vector
     {
     private:
@@ -38,14 +102,21 @@ namespace mystl
         {}
 
         explicit vector(size_type count, const Allocator& alloc = Allocator()) :
-            _alloc{alloc}, _sz{count}, _cap{count}, _data{alloc_traits::allocate(_alloc, count)}
+            _alloc{alloc}, _sz{count}, _cap{count}, _data{allocate(count)}
         {
-            for (size_type i = 0; i < _sz; ++i)
-                alloc_traits::construct(_alloc, _data + i);
+            try
+            {
+                value_construct_n(_data, count);
+            }
+            catch (...)
+            {
+                deallocate(_data, _cap);
+                throw;
+            }
         }
 
         constexpr vector(size_type count, const T& value, const Allocator& alloc = Allocator()) :
-            _alloc{alloc}, _sz{count}, _cap{count}, _data{alloc_traits::allocate(_alloc, count)}
+            _alloc{alloc}, _sz{count}, _cap{count}, _data{allocate(count)}
         {
             for (size_type i = 0; i < _sz; ++i)
                 alloc_traits::construct(_alloc, _data + i, value);
@@ -53,7 +124,7 @@ namespace mystl
 
         template<typename InputIt>
         constexpr vector(InputIt first, InputIt last, const Allocator& alloc = Allocator()) :
-            _alloc{alloc}, _sz{static_cast<size_type>(std::distance(first, last))}, _cap{_sz}, _data{alloc_traits::allocate(_alloc, _cap)}
+            _alloc{alloc}, _sz{static_cast<size_type>(std::distance(first, last))}, _cap{_sz}, _data{allocate(_cap)}
         {
             std::uninitialized_copy(first, last, _data);
         }
@@ -62,7 +133,7 @@ namespace mystl
             _alloc{alloc_traits::select_on_container_copy_construction(other.get_allocator())},
             _sz{other._sz},
             _cap{other._cap},
-            _data{alloc_traits::allocate(_alloc, _cap)}
+            _data{allocate(_cap)}
         {
             std::uninitialized_copy_n(other._data, other._sz, _data);
         }
@@ -89,7 +160,7 @@ namespace mystl
 
             for (size_type i = 0; i < _sz; ++i)
                 alloc_traits::destroy(_alloc, _data + i);
-            alloc_traits::deallocate(_alloc, _data, _cap);
+            deallocate(_data, _cap);
         }
 
         // Assignments
@@ -127,7 +198,7 @@ namespace mystl
             {
                 // Reuse existing memory if capacity is large enough
                 auto copy_to = other._sz > _cap
-                    ? alloc_traits::allocate(_alloc, other._cap)
+                    ? allocate(other._cap)
                     : _data;
 
                 std::copy(other.begin(), other.end(), copy_to);
@@ -137,7 +208,7 @@ namespace mystl
 
                 if (copy_to != _data)
                 {
-                    alloc_traits::deallocate(_alloc, _data, _cap);
+                    deallocate(_data, _cap);
                     _data = copy_to;
                     _cap = other._cap;
                 }
@@ -159,7 +230,7 @@ namespace mystl
                 _alloc = other.get_allocator();
                 for (size_type i = 0; i < _sz; ++i)
                     alloc_traits::destroy(_alloc, _data + i);
-                alloc_traits::deallocate(_alloc, _data, _cap);
+                deallocate(_data, _cap);
                 _data = other._data;
             }
             else
@@ -168,14 +239,14 @@ namespace mystl
                 {
                     for (size_type i = 0; i < _sz; ++i)
                         alloc_traits::destroy(_alloc, _data + i);
-                    alloc_traits::deallocate(_alloc, _data, _cap);
+                    deallocate(_data, _cap);
                     _data = other._data;
                 }
                 else
                 {
                     // Not allowed to copy other's allocator. Move elements individually (alloc more mem. if necessary)
                     auto move_to = other._cap != _cap
-                        ? alloc_traits::allocate(_alloc, other._cap)
+                        ? allocate(other._cap)
                         : _data;
 
                     std::move(other.begin(), other.end(), move_to);
@@ -184,7 +255,7 @@ namespace mystl
                     {
                         for (size_type i = 0; i < _sz; ++i)
                             alloc_traits::destroy(_alloc, _data + i);
-                        alloc_traits::deallocate(_alloc, _data, _cap);
+                        deallocate(_data, _cap);
                         _data = move_to;
                     }
                 }
@@ -252,13 +323,30 @@ namespace mystl
         template<typename TVal>
         constexpr void push_back(TVal&& value)
         {
-            maybe_expand();
-            alloc_traits::construct(_alloc, _data + _sz++, std::forward<TVal>(value));
+            emplace_back(std::forward<TVal>(value));
         }
         template<typename... Args>
         constexpr reference emplace_back(Args&&... args)
         {
-            maybe_expand();
+            if (_sz == _cap)
+            {
+                if constexpr (grows_in_place)
+                {
+                    if !consteval
+                    {
+                        // realloc (or mremap) can often extend the buffer where it is, but frees it if it
+                        // has to move, so the element is built first in case args refer to one of ours
+                        T new_elem(std::forward<Args>(args)...);
+                        reallocate(grown_capacity(_sz + 1));
+                        alloc_traits::construct(_alloc, _data + _sz, std::move(new_elem));
+                        return _data[_sz++];
+                    }
+                }
+
+                // Build into the new buffer when growing, so that args referring to our own elements stay valid
+                return *insert_realloc(_sz, 1, [&](pointer dest) { alloc_traits::construct(_alloc, dest, std::forward<Args>(args)...); });
+            }
+
             alloc_traits::construct(_alloc, _data + _sz, std::forward<Args>(args)...);
             return _data[_sz++];
         }
@@ -266,42 +354,56 @@ namespace mystl
         template<typename TVal>
         constexpr iterator insert(const_iterator pos, TVal&& value)
         {
-            const auto index = pos - cbegin();
-            maybe_expand();
-            std::uninitialized_move_n(rbegin(), _sz - index, std::prev(rbegin()));
-            const auto ins = begin() + index;
-            alloc_traits::construct(_alloc, ins, std::forward<TVal>(value));
-            ++_sz;
-            return ins;
+            return emplace(pos, std::forward<TVal>(value));
         }
         constexpr iterator insert(const_iterator pos, size_type count, const T& value)
         {
-            // TODO: Possible to eliminate moves when expansion is required (Perform action on new mem, then copy old elems to correct new pos)
-            const auto index = pos - cbegin();
-            maybe_expand(count);
+            const auto index = static_cast<size_type>(pos - cbegin());
+            if (count == 0)
+                return begin() + index;
 
-            auto d_it = rbegin();
-            std::advance(d_it, -count);
-            std::uninitialized_move_n(rbegin(), _sz - index, d_it);
-            const auto ins = begin() + index;
-            std::uninitialized_fill_n(ins, count, value);
-            _sz += count;
-            return ins;
+            if (_sz + count <= _cap && contains(std::addressof(value)))
+            {
+                // Shifting the elements would move value from under us
+                const T copy(value);
+                return insert_with(index, count, [&](pointer dest) { detail::construct_n(_alloc, dest, count, copy); });
+            }
+
+            return insert_with(index, count, [&](pointer dest) { detail::construct_n(_alloc, dest, count, value); });
         }
-        template<typename InputIt>
+        template<std::input_iterator InputIt>
         constexpr iterator insert(const_iterator pos, InputIt first, InputIt last)
         {
-            const auto index = pos - cbegin();
-            maybe_expand();
+            const auto index = static_cast<size_type>(pos - cbegin());
 
-            const auto cnt = static_cast<size_type>(std::distance(first, last));
-            auto d_it = rbegin();
-            std::advance(d_it, -cnt);
-            std::uninitialized_move_n(rbegin(), _sz - index, d_it);
-            const auto ins = begin() + index;
-            std::uninitialized_copy(first, last, ins);
-            _sz += cnt;
-            return ins;
+            if constexpr (std::forward_iterator<InputIt>)
+            {
+                // Size the growth up front so the elements are shifted at most once
+                const auto count = static_cast<size_type>(std::distance(first, last));
+                return insert_with(index, count, [&](pointer dest)
+                {
+                    size_type i = 0;
+                    try
+                    {
+                        for (; first != last; ++first, ++i)
+                            alloc_traits::construct(_alloc, dest + i, *first);
+                    }
+                    catch (...)
+                    {
+                        detail::destroy_n(_alloc, dest, i);
+                        throw;
+                    }
+                });
+            }
+            else
+            {
+                // Length is unknown up front. Append, then rotate into place
+                const auto old_sz = _sz;
+                for (; first != last; ++first)
+                    emplace_back(*first);
+                std::rotate(begin() + index, begin() + old_sz, end());
+                return begin() + index;
+            }
         }
         constexpr iterator insert(const_iterator pos, std::initializer_list<T> ilist)
         {
@@ -311,48 +413,57 @@ namespace mystl
         template<typename... Args>
         constexpr iterator emplace(const_iterator pos, Args&&... args)
         {
-            // TODO: Possible to eliminate moves when expansion is required (Perform action on new mem, then copy old elems to correct new pos)
-            const auto index = pos - cbegin();
-            maybe_expand();
+            const auto index = static_cast<size_type>(pos - cbegin());
 
-            const auto ins = begin() + index;
-            if (ins == end())
-                alloc_traits::construct(_alloc, ins, std::forward<Args>(args)...);
-            else
+            if (_sz < _cap && index != _sz)
             {
+                // Build the element first, args may refer to elements about to be shifted
                 T new_elem(std::forward<Args>(args)...);
-                std::uninitialized_move_n(rbegin(), _sz - index, std::prev(rbegin()));
-                *ins = std::move(new_elem);
+                return insert_with(index, 1, [&](pointer dest) { alloc_traits::construct(_alloc, dest, std::move(new_elem)); });
             }
 
-            ++_sz;
-            return ins;
+            return insert_with(index, 1, [&](pointer dest) { alloc_traits::construct(_alloc, dest, std::forward<Args>(args)...); });
         }
 
         constexpr iterator erase(const_iterator pos)
         {
-            alloc_traits::destroy(_alloc, pos);
-            const auto ers = const_cast<iterator>(pos); // Forgive me
-            for (auto it = ers; it != end() - 1; ++it)
-                *it = std::move(*(it + 1));
-            --_sz;
-            return ers;
+            return erase(pos, pos + 1);
         }
         constexpr iterator erase(const_iterator first, const_iterator last)
         {
-            if (first == last)
-                return const_cast<iterator>(last); // Please forgive me
+            const auto index = static_cast<size_type>(first - cbegin());
+            const auto cnt = static_cast<size_type>(last - first);
+            const auto ers = begin() + index;
+            if (cnt == 0)
+                return ers;
 
-            const auto cnt = last - first;
-            for (auto it = first; it != last; ++it)
-                alloc_traits::destroy(_alloc, it);
+            if constexpr (memcpy_relocatable)
+            {
+                if !consteval
+                {
+                    // The tail can be moved down in one go, there's nothing to run per element
+                    detail::destroy_n(_alloc, ers, cnt);
+                    std::memmove(std::to_address(ers), std::to_address(ers + cnt), (_sz - index - cnt) * sizeof(T));
+                    _sz -= cnt;
+                    return ers;
+                }
+            }
 
-            auto fr = const_cast<iterator>(last);
-            auto to = const_cast<iterator>(first);
-            while (fr != end())
-                *to++ = std::move(*fr++);
+            // Shift the tail down over the erased elements, then destroy the leftover moved-from ones
+            std::move(ers + cnt, end(), ers);
+            detail::destroy_n(_alloc, end() - cnt, cnt);
             _sz -= cnt;
-            return const_cast<iterator>(first);
+            return ers;
+        }
+
+        // Erases pos by moving the last element into its place. O(1), but doesn't keep the order
+        constexpr iterator erase_unordered(const_iterator pos)
+        {
+            const auto ers = begin() + (pos - cbegin());
+            if (ers != end() - 1)
+                *ers = std::move(back());
+            pop_back();
+            return ers;
         }
 
         constexpr void pop_back()
@@ -361,8 +472,57 @@ namespace mystl
                 alloc_traits::destroy(_alloc, _data + --_sz);
         }
 
-        constexpr void resize(size_type count) { resize_impl(count); }
-        constexpr void resize(size_type count, const value_type& value) { resize_impl(count, value); }
+        constexpr void resize(size_type count)
+        {
+            resize_with(count, [this](pointer first, size_type n) { value_construct_n(first, n); });
+        }
+        constexpr void resize(size_type count, const value_type& value)
+        {
+            if (count > _cap && contains(std::addressof(value)))
+            {
+                // Growing frees the buffer value lives in before the new elements are built
+                const T copy(value);
+                resize_impl(count, copy);
+                return;
+            }
+
+            resize_impl(count, value);
+        }
+
+        void resize(parallel_construct par, size_type count)
+        {
+            resize_with(count, [this, par](pointer first, size_type n)
+            {
+                construct_on_threads(first, n, par.threads, [this](pointer f, size_type m) { value_construct_n(f, m); });
+            });
+        }
+
+        /*
+         * Like resize, but new elements are default-initialised instead of value-initialised,
+         * which leaves arithmetic types and other trivial types with indeterminate values. Meant
+         * for buffers that are about to be overwritten anyway (e.g. by I/O), saving a pass that
+         * zeroes them first. Allocators that customise construct() still get to construct them.
+         */
+        constexpr void resize_for_overwrite(size_type count)
+        {
+            resize_with(count, [this](pointer first, size_type n) { default_construct_n(first, n); });
+        }
+
+        void resize_for_overwrite(parallel_construct par, size_type count)
+        {
+            resize_with(count, [this, par](pointer first, size_type n)
+            {
+                construct_on_threads(first, n, par.threads, [this](pointer f, size_type m) { default_construct_n(f, m); });
+            });
+        }
+
+        // Appends count default-initialised elements and returns them for the caller to fill in
+        constexpr std::span<T> append_uninitialized(size_type count)
+        {
+            const auto old_sz = _sz;
+            resize_for_overwrite(_sz + count);
+            return {std::to_address(_data + old_sz), count};
+        }
         /**********************************************************************/
 
         // Capacity
@@ -375,27 +535,24 @@ namespace mystl
             if (new_cap <= _cap)
                 return;
 
-            auto new_data = alloc_traits::allocate(_alloc, new_cap);
-
-            /*
-             * This is an observation from gcc's implementation, which copies the
-             * old data instead of moving them, and it surprised me because moving
-             * the data would be a more efficient approach. However, it dawned on
-             * me that doing so will violate the requirement of leaving the container
-             * in a valid state (i.e. before expansion) if an exception is thrown
-             * (e.g. whilst moving an element).
-             * 
-             * This reveals a possible reason to implement a more efficient custom
-             * vector-like container if one can guarantee that the move operation
-             * on their elements will never throw exceptions.
-             */
-            std::uninitialized_copy_n(_data, _sz, new_data);
-
-            std::swap(_cap, new_cap);
-            std::swap(_data, new_data);
-            for (size_type i = 0; i < _sz; ++i)
-                alloc_traits::destroy(_alloc, new_data + i);
-            alloc_traits::deallocate(_alloc, new_data, new_cap);
+            reallocate(new_cap);
+        }
+
+        // Releases unused capacity, reallocating to exactly size() elements
+        constexpr void shrink_to_fit()
+        {
+            if (_sz == _cap)
+                return;
+
+            if (_sz == 0)
+            {
+                deallocate(_data, _cap);
+                _data = nullptr;
+                _cap = 0;
+                return;
+            }
+
+            reallocate(_sz);
         }
         /**********************************************************************/
 
@@ -427,19 +584,184 @@ namespace mystl
         }
 
     private:
+        static constexpr bool allocator_constructs = detail::allocator_constructs<T, Allocator>;
+        static constexpr bool memcpy_relocatable = detail::memcpy_relocatable<T, Allocator>;
+        static constexpr bool nothrow_shift = detail::nothrow_shift<T, Allocator>;
+
+        // Allocators may offer reallocate(p, old_count, new_count), resizing a block while keeping
+        // its bytes (e.g. mmap_allocator, with mremap). Only usable for memcpy-relocatable elements
+        static constexpr bool allocator_reallocates = requires(Allocator& a, pointer p, size_type n) { { a.reallocate(p, n, n) } -> std::same_as<pointer>; };
+
+        // With the default allocator, memcpy-relocatable elements live in malloc-ed memory so
+        // that growing can use realloc, which extends the block in place whenever it can
+        static constexpr bool uses_realloc =
+            memcpy_relocatable
+            && std::is_same_v<Allocator, std::allocator<T>>
+            && alignof(T) <= alignof(std::max_align_t);
+
+        // Growing keeps the bytes where they are, or has realloc/the allocator move them, without a second buffer
+        static constexpr bool grows_in_place = uses_realloc || (memcpy_relocatable && allocator_reallocates);
+
         allocator_type _alloc;
         size_type _sz, _cap;
         pointer _data;
 
+        constexpr pointer allocate(size_type count)
+        {
+            if constexpr (uses_realloc)
+            {
+                if !consteval
+                {
+                    if (count > std::numeric_limits<size_type>::max() / sizeof(T))
+                        throw std::bad_array_new_length{};
+
+                    const auto p = static_cast<pointer>(std::malloc(count * sizeof(T)));
+                    if (p == nullptr && count != 0)
+                        throw std::bad_alloc{};
+                    return p;
+                }
+            }
+
+            return alloc_traits::allocate(_alloc, count);
+        }
+
+        constexpr void deallocate(pointer p, size_type count)
+        {
+            if (p == nullptr)
+                return;
+
+            if constexpr (uses_realloc)
+            {
+                if !consteval
+                {
+                    std::free(p);
+                    return;
+                }
+            }
+
+            alloc_traits::deallocate(_alloc, p, count);
+        }
+
+        // Moves the elements into a buffer of new_cap (>= _sz) elements, which may also be a shrink
+        constexpr void reallocate(size_type new_cap)
+        {
+            if constexpr (uses_realloc)
+            {
+                if !consteval
+                {
+                    if (new_cap > std::numeric_limits<size_type>::max() / sizeof(T))
+                        throw std::bad_array_new_length{};
+
+#if defined(__GLIBC__)
+                    // The block handed out by malloc may already be large enough
+                    if (new_cap > _cap && _data != nullptr && malloc_usable_size(_data) >= new_cap * sizeof(T))
+                    {
+                        _cap = new_cap;
+                        return;
+                    }
+#endif
+
+                    const auto new_data = static_cast<pointer>(std::realloc(_data, new_cap * sizeof(T)));
+                    if (new_data == nullptr)
+                        throw std::bad_alloc{};
+
+                    _data = new_data;
+                    _cap = new_cap;
+                    return;
+                }
+            }
+            else if constexpr (memcpy_relocatable && allocator_reallocates)
+            {
+                if !consteval
+                {
+                    _data = _alloc.reallocate(_data, _cap, new_cap);
+                    _cap = new_cap;
+                    return;
+                }
+            }
+
+            auto new_data = allocate(new_cap);
+            try
+            {
+                detail::relocate(_alloc, _data, _sz, new_data);
+            }
+            catch (...)
+            {
+                deallocate(new_data, new_cap);
+                throw;
+            }
+
+            deallocate(_data, _cap);
+            _data = new_data;
+            _cap = new_cap;
+        }
+
         constexpr void maybe_expand(size_type expand_by = 1)
         {
             const auto expand_to = _sz + expand_by;
             if (expand_to <= _cap)
                 return;
 
-            auto newCap = _cap == 0 ? 1 : _cap;
-            while (newCap <= expand_to) newCap <<= 1; // Keep doubling until large enough
-            reserve(newCap);
+            reserve(grown_capacity(expand_to));
+        }
+
+        constexpr size_type grown_capacity(size_type expand_to) const
+        {
+            return GrowthPolicy::next_capacity(_cap, expand_to, sizeof(T));
+        }
+
+        constexpr bool contains(const T* p) const noexcept
+        {
+            if consteval
+            {
+                // Ordering unrelated pointers isn't a constant expression, but comparing them for equality is
+                for (size_type i = 0; i < _sz; ++i)
+                    if (std::to_address(_data + i) == p)
+                        return true;
+                return false;
+            }
+
+            return std::less_equal<>{}(std::to_address(_data), p) && std::less<>{}(p, std::to_address(_data) + _sz);
+        }
+
+        /*
+         * Moves to a new buffer (grown if count more elements don't fit) with count elements at
+         * index, having construct(dest) build them there before the existing elements are moved
+         * around them. If anything throws, the vector is left as it was.
+         */
+        template<typename Construct>
+        constexpr iterator insert_realloc(size_type index, size_type count, Construct&& construct)
+        {
+            const auto new_cap = _sz + count > _cap ? grown_capacity(_sz + count) : _cap;
+            const auto new_data = allocate(new_cap);
+            try
+            {
+                detail::build_around(_alloc, _data, _sz, new_data, index, count, std::forward<Construct>(construct));
+            }
+            catch (...)
+            {
+                deallocate(new_data, new_cap);
+                throw;
+            }
+
+            deallocate(_data, _cap);
+            _data = new_data;
+            _cap = new_cap;
+            _sz += count;
+            return begin() + index;
+        }
+
+        // Makes room for count elements at index and has construct(dest) build them there
+        template<typename Construct>
+        constexpr iterator insert_with(size_type index, size_type count, Construct&& construct)
+        {
+            // A shift whose moves may throw can't be undone halfway, so those go through a new buffer
+            if (_sz + count > _cap || (index != _sz && !nothrow_shift))
+                return insert_realloc(index, count, std::forward<Construct>(construct));
+
+            detail::insert_in_place(_alloc, _data, _sz, index, count, std::forward<Construct>(construct));
+            _sz += count;
+            return begin() + index;
         }
 
         inline constexpr void check_bounds(size_type pos) const
@@ -448,6 +770,110 @@ namespace mystl
                 throw std::out_of_range{std::format("vector: index {} out of range of size {}", pos, _sz)};
         }
 
+        constexpr void value_construct_n(pointer first, size_type count)
+        {
+            if constexpr (!allocator_constructs)
+            {
+                if !consteval
+                {
+                    // Lets trivial types be zeroed with a single memset
+                    std::uninitialized_value_construct_n(std::to_address(first), count);
+                    return;
+                }
+            }
+
+            size_type i = 0;
+            try
+            {
+                for (; i < count; ++i)
+                    alloc_traits::construct(_alloc, first + i);
+            }
+            catch (...)
+            {
+                detail::destroy_n(_alloc, first, i);
+                throw;
+            }
+        }
+
+        constexpr void default_construct_n(pointer first, size_type count)
+        {
+            if constexpr (!allocator_constructs)
+            {
+                if !consteval
+                {
+                    std::uninitialized_default_construct_n(std::to_address(first), count);
+                    return;
+                }
+            }
+
+            // Constant evaluation can't leave objects uninitialised
+            value_construct_n(first, count);
+        }
+
+        // Splits [first, first + count) into chunks and runs fill(chunk_first, chunk_count) on a thread each
+        template<typename Fill>
+        void construct_on_threads(pointer first, size_type count, unsigned threads, Fill fill)
+        {
+            // Below this many bytes per thread, starting the threads costs more than it saves
+            constexpr size_type MIN_CHUNK_BYTES = 1 << 20;
+
+            if (threads == 0)
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            const auto chunks = std::min<size_type>(threads, count * sizeof(T) / MIN_CHUNK_BYTES);
+            if (chunks <= 1)
+            {
+                fill(first, count);
+                return;
+            }
+
+            const auto chunk_sz = (count + chunks - 1) / chunks;
+            const auto errors = std::make_unique<std::exception_ptr[]>(chunks);
+            {
+                const auto workers = std::make_unique<std::jthread[]>(chunks);
+                for (size_type c = 0; c < chunks; ++c)
+                {
+                    workers[c] = std::jthread([&, c]
+                    {
+                        const auto begin = c * chunk_sz;
+                        try
+                        {
+                            fill(first + begin, std::min(chunk_sz, count - begin));
+                        }
+                        catch (...)
+                        {
+                            errors[c] = std::current_exception();
+                        }
+                    });
+                }
+            } // Joins the workers
+
+            const auto failed = std::find_if(errors.get(), errors.get() + chunks, [](const auto& e) { return e != nullptr; });
+            if (failed == errors.get() + chunks)
+                return;
+
+            // A failed chunk has cleaned up after itself, the others have to be undone
+            for (size_type c = 0; c < chunks; ++c)
+                if (errors[c] == nullptr)
+                    detail::destroy_n(_alloc, first + c * chunk_sz, std::min(chunk_sz, count - c * chunk_sz));
+            std::rethrow_exception(*failed);
+        }
+
+        // Resizes to count, having construct_new(first, n) build any new elements
+        template<typename ConstructNew>
+        constexpr void resize_with(size_type count, ConstructNew construct_new)
+        {
+            if (count <= _sz)
+            {
+                detail::destroy_n(_alloc, _data + count, _sz - count);
+                _sz = count;
+                return;
+            }
+
+            maybe_expand(count - _sz);
+            construct_new(_data + _sz, count - _sz);
+            _sz = count;
+        }
+
         template<typename... Args>
         constexpr void resize_impl(size_type count, Args&&... args)
         {
@@ -470,4 +896,21 @@ namespace mystl
             _sz = count;
         }
     };
+
+    // Erases every element equal to value in a single pass. Returns the number erased
+    template<typename T, typename Allocator, typename GrowthPolicy, typename U>
+    constexpr typename vector<T, Allocator, GrowthPolicy>::size_type erase(vector<T, Allocator, GrowthPolicy>& c, const U& value)
+    {
+        return erase_if(c, [&value](const auto& elem) { return elem == value; });
+    }
+
+    // Erases every element satisfying pred in a single pass. Returns the number erased
+    template<typename T, typename Allocator, typename GrowthPolicy, typename Pred>
+    constexpr typename vector<T, Allocator, GrowthPolicy>::size_type erase_if(vector<T, Allocator, GrowthPolicy>& c, Pred pred)
+    {
+        const auto it = std::remove_if(c.begin(), c.end(), pred);
+        const auto cnt = static_cast<typename vector<T, Allocator, GrowthPolicy>::size_type>(c.end() - it);
+        c.erase(it, c.end());
+        return cnt;
+    }
 }
@@ -0,0 +1,61 @@
+#include "dfa.h"
+
+#include <algorithm>
+
+namespace Regex
+{
+    DFA::DFA(State *nfaStart, std::size_t maxCacheBytes) :
+        nfaStart{nfaStart}, maxCacheBytes{maxCacheBytes}
+    {}
+
+    int DFA::Start()
+    {
+        if (nfaStart == nullptr)
+            return DEAD_STATE;
+
+        if (startState == UNKNOWN_STATE)
+            startState = AddState(NFA::EpsilonClosure({nfaStart}));
+
+        return startState;
+    }
+
+    int DFA::Next(int state, char c)
+    {
+        auto &next = states[state].next[static_cast<unsigned char>(c)];
+        if (next != UNKNOWN_STATE)
+            return next;
+
+        const auto result = AddState(NFA::EpsilonClosure(NFA::Move(*states[state].nfaStates, c)));
+
+        // Looked up again, AddState may have grown the vector. The cache never frees anything,
+        // so a CACHE_FULL result is final and is remembered like any other
+        states[state].next[static_cast<unsigned char>(c)] = result;
+
+        return result;
+    }
+
+    int DFA::AddState(std::set<State *> &&nfaStates)
+    {
+        if (nfaStates.empty())
+            return DEAD_STATE;
+
+        if (const auto it = ids.find(nfaStates); it != ids.end())
+            return it->second;
+
+        // Rough footprint: the DState itself plus the set stored as a map key (~4 words per tree node)
+        const auto bytes = sizeof(DState) + nfaStates.size() * (sizeof(State *) + 4 * sizeof(void *));
+        if (cacheBytes + bytes > maxCacheBytes)
+            return CACHE_FULL;
+
+        cacheBytes += bytes;
+
+        const auto isAccepting = std::ranges::any_of(nfaStates, [](const State *s) { return s->isAccepting; });
+        const auto id = static_cast<int>(states.size());
+        const auto [it, _] = ids.emplace(std::move(nfaStates), id);
+
+        auto &dState = states.emplace_back(&it->first, isAccepting);
+        dState.next.fill(UNKNOWN_STATE);
+
+        return id;
+    }
+}
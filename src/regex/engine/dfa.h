@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "nfa.h"
+
+namespace Regex
+{
+    // DFA built lazily from an NFA via subset construction, one transition at a time.
+    // Memory held by the cached states is bounded; once the budget is spent no new
+    // states are added, and the caller is expected to continue with the NFA instead.
+    class DFA
+    {
+    public:
+        static constexpr int DEAD_STATE = -1;
+        static constexpr int CACHE_FULL = -2;
+
+        DFA() = default; // Matches nothing
+        DFA(State *nfaStart, std::size_t maxCacheBytes);
+
+        int Start();
+        int Next(int state, char c);
+
+        bool IsAccepting(int state) const { return states[state].isAccepting; }
+        const std::set<State *> &NFAStates(int state) const { return *states[state].nfaStates; }
+
+        std::size_t CacheBytes() const { return cacheBytes; }
+
+    private:
+        static constexpr int UNKNOWN_STATE = -3;
+
+        struct DState
+        {
+            const std::set<State *> *nfaStates;
+            bool isAccepting;
+            std::array<int, 256> next;
+        };
+
+        State *nfaStart = nullptr;
+        int startState = UNKNOWN_STATE;
+        std::vector<DState> states;
+        std::map<std::set<State *>, int> ids;
+        std::size_t cacheBytes = 0;
+        std::size_t maxCacheBytes = 0;
+
+        int AddState(std::set<State *> &&nfaStates);
+    };
+}
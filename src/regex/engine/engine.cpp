@@ -1,23 +1,58 @@
 #include "engine.h"
 
-#include <regex>
-#include <iostream>
+#include <string>
 
 namespace Regex
 {
     void Engine::Compile()
     {
         pos = 0;
-        nfa = ParseExpr();
-        nfa.Print();
+        depth = 0;
+        auto parsed = ParseExpr();
+
+        if (!IsAtEnd())
+            throw RegexError{ErrorCode::UnbalancedParen, "unmatched ')' at position " + std::to_string(pos)};
+
+        // Only replaced once parsing succeeded, the DFA points into the NFA's states
+        nfa = std::move(parsed);
+        dfa = DFA{nfa.startState, limits.maxDFACacheBytes};
     }
 
     bool Engine::Matches(std::string_view input)
     {
-        auto currStates = NFA::EpsilonClosure({nfa.startState});
+        auto state = dfa.Start();
+        if (state == DFA::DEAD_STATE)
+            return false;
+        if (state == DFA::CACHE_FULL)
+            return MatchesNFA(input, NFA::EpsilonClosure({nfa.startState}));
 
+        for (std::size_t i = 0; i < input.size(); ++i)
+        {
+            const auto next = dfa.Next(state, input[i]);
+            if (next == DFA::DEAD_STATE)
+                return false;
+            if (next == DFA::CACHE_FULL)
+            {
+                // Out of cache budget, finish the scan with the (slower, but bounded) NFA simulation
+                auto currStates = dfa.NFAStates(state);
+                return MatchesNFA(input.substr(i), std::move(currStates));
+            }
+
+            state = next;
+        }
+
+        return dfa.IsAccepting(state);
+    }
+
+    // Only this simulation is charged scan steps: it visits every live state per byte, where the DFA scan is linear
+    bool Engine::MatchesNFA(std::string_view input, std::set<State *> &&currStates) const
+    {
+        std::size_t steps = 0;
         for (const auto c : input)
         {
+            steps += currStates.size();
+            CheckScanLimit(steps);
+
             currStates = NFA::EpsilonClosure(NFA::Move(currStates, c));
             if (currStates.empty())
                 return false;
@@ -30,6 +65,24 @@ namespace Regex
         return false;
     }
 
+    void Engine::CheckStateLimit(const NFA &n) const
+    {
+        if (n.StateCount() > limits.maxNFAStates)
+            throw RegexError{
+                ErrorCode::StateLimitExceeded,
+                "pattern needs more than " + std::to_string(limits.maxNFAStates) + " NFA states"
+            };
+    }
+
+    void Engine::CheckScanLimit(std::size_t steps) const
+    {
+        if (steps > limits.maxScanSteps)
+            throw RegexError{
+                ErrorCode::ScanLimitExceeded,
+                "match exceeded " + std::to_string(limits.maxScanSteps) + " scan steps"
+            };
+    }
+
     NFA Engine::ParseExpr() { return ParseUnion(); }
 
     NFA Engine::ParseUnion()
@@ -40,6 +93,7 @@ namespace Regex
             ++pos;
             auto rUnion = ParseConcat();
             result = NFA::MakeUnion(std::move(result), std::move(rUnion));
+            CheckStateLimit(result);
         }
 
         return result;
@@ -52,6 +106,7 @@ namespace Regex
         {
             auto concatNFA = ParseDuplication();
             result = NFA::MakeConcat(std::move(result), std::move(concatNFA));
+            CheckStateLimit(result);
         }
 
         return result;
@@ -73,6 +128,9 @@ namespace Regex
 
             ++pos;
             result = makeNFA(std::move(result));
+
+            // Checked after every step so nested '+' can at most double an NFA that was within limits
+            CheckStateLimit(result);
         }
 
         return result;
@@ -89,12 +147,19 @@ namespace Regex
             return NFA::MakeChar(currChar); // Read single char
 
         // Capture group
+        if (++depth > limits.maxNestingDepth)
+            throw RegexError{
+                ErrorCode::NestingLimitExceeded,
+                "groups nested more than " + std::to_string(limits.maxNestingDepth) + " deep at position " + std::to_string(pos - 1)
+            };
+
         auto result = ParseExpr();
+        --depth;
 
         if (!IsAtEnd() && Peek() == ')')
             ++pos;
         else
-            throw std::regex_error{std::regex_constants::error_paren}; // TODO: Throw something proper
+            throw RegexError{ErrorCode::UnbalancedParen, "missing ')' at position " + std::to_string(pos)};
 
         return result;
     }
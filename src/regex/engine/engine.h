@@ -1,16 +1,30 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
 #include "nfa.h"
+#include "dfa.h"
+#include "error.h"
 
 namespace Regex
 {
+    // Resource bounds for compiling and matching patterns that come from untrusted sources
+    struct Limits
+    {
+        std::size_t maxNFAStates = 10000;
+        std::size_t maxDFACacheBytes = 1 << 20; // Exceeding this falls back to NFA simulation
+        std::size_t maxScanSteps = 1 << 24;     // States visited per Matches() call once it falls back to NFA simulation
+        std::size_t maxNestingDepth = 256;      // Groups open at once, each one recurses through the parser
+    };
+
     class Engine
     {
     public:
-        Engine(const std::string &regex) : pattern{regex}, pos{0} {}
+        Engine(const std::string &regex, const Limits &limits = {}) :
+            pattern{regex}, pos{0}, depth{0}, limits{limits}, dfa{nfa.startState, limits.maxDFACacheBytes}
+        {}
 
         void Compile();
         bool Matches(std::string_view input);
@@ -18,7 +32,10 @@ namespace Regex
     private:
         std::string pattern;
         int pos;
+        std::size_t depth;
+        Limits limits;
         NFA nfa;
+        DFA dfa;
 
         NFA ParseExpr();
         NFA ParseUnion();
@@ -26,6 +43,10 @@ namespace Regex
         NFA ParseDuplication();
         NFA ParseAtom();
 
+        bool MatchesNFA(std::string_view input, std::set<State *> &&currStates) const;
+        void CheckStateLimit(const NFA &n) const;
+        void CheckScanLimit(std::size_t steps) const;
+
         char Advance();
         char Peek() const;
         bool IsAtEnd() const;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace Regex
+{
+    enum class ErrorCode
+    {
+        UnbalancedParen,
+        StateLimitExceeded,
+        ScanLimitExceeded,
+        NestingLimitExceeded,
+    };
+
+    class RegexError : public std::runtime_error
+    {
+    public:
+        RegexError(ErrorCode code, const std::string &what) : std::runtime_error{what}, code{code} {}
+
+        ErrorCode Code() const noexcept { return code; }
+
+    private:
+        ErrorCode code;
+    };
+}
@@ -44,6 +44,8 @@ namespace Regex
 
         void Print() const;
 
+        std::size_t StateCount() const { return states.size(); }
+
         State *startState;
         State *acceptingState;
 
@@ -11,7 +11,15 @@ int main()
     std::cout << "Input string: ";
     std::cin >> input;
 
-    Regex::Engine engine{regex};
-    engine.Compile();
-    std::cout << engine.Matches(input) << std::endl;
+    try
+    {
+        Regex::Engine engine{regex};
+        engine.Compile();
+        std::cout << engine.Matches(input) << std::endl;
+    }
+    catch (const Regex::RegexError &e)
+    {
+        std::cerr << "regex error: " << e.what() << std::endl;
+        return 1;
+    }
 }